@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+Compare bench results against the stored baseline.
+
+    ./bench/compare.py bench/out/results.json bench/baseline.json
+    ./bench/compare.py --update bench/out/results.json bench/baseline.json
+
+Every metric is lower-is-better. A metric fails when
+
+    value > baseline * (1 + tolerance) + slack
+
+where tolerance is per metric (a fraction: 0.5 = 50% slower allowed) and
+slack is an optional absolute noise floor in the metric's unit (default 0).
+ns-scale metrics need it: a few ns of scheduler or frequency noise is
+already several times their baseline.
+Metrics in the baseline but missing from the results (skipped on this
+machine) are reported, not failed. Exit status 1 on any failure.
+
+--update writes the measured values into the baseline, keeping each
+metric's tolerance and slack (new metrics get DEFAULT_TOLERANCE, no slack).
+"""
+
+import sys
+import json
+import argparse
+
+DEFAULT_TOLERANCE = 0.5
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare bench results with a baseline')
+    parser.add_argument('results', help='results.json from bench/run.sh')
+    parser.add_argument('baseline', help='baseline.json with per-metric thresholds')
+    parser.add_argument('--update', action='store_true', help='Store the results as the new baseline')
+    args = parser.parse_args()
+
+    with open(args.results) as f:
+        results = json.load(f)["metrics"]
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    if args.update:
+        metrics = baseline.setdefault("metrics", {})
+        for name, value in sorted(results.items()):
+            entry = metrics.setdefault(name, {"tolerance": DEFAULT_TOLERANCE})
+            entry["baseline"] = value
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Baseline updated: {args.baseline} ({len(results)} metrics)")
+        return 0
+
+    failed = []
+    print(f"{'metric':<28} {'value':>10} {'baseline':>10} {'limit':>10}  result")
+    for name, spec in sorted(baseline.get("metrics", {}).items()):
+        base = spec["baseline"]
+        limit = base * (1 + spec.get("tolerance", DEFAULT_TOLERANCE)) + spec.get("slack", 0)
+        value = results.get(name)
+        if value is None:
+            print(f"{name:<28} {'-':>10} {base:>10.2f} {limit:>10.2f}  skipped")
+            continue
+        ok = value <= limit
+        if not ok:
+            failed.append(name)
+        print(f"{name:<28} {value:>10.2f} {base:>10.2f} {limit:>10.2f}  {'ok' if ok else 'REGRESSION'}")
+
+    for name in sorted(set(results) - set(baseline.get("metrics", {}))):
+        print(f"{name:<28} {results[name]:>10.2f} {'-':>10} {'-':>10}  new (no baseline)")
+
+    if failed:
+        print(f"\nREGRESSION: {', '.join(failed)}")
+        return 1
+    print("\nNo regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,283 @@
+/*
+ * Host-side benchmark of the GRUB gamepad decode path
+ *
+ * Builds src/usb_snes_gamepad.c against the header shim in bench/shim,
+ * attaches a fake pad through the real attach hook and drives
+ * grub_usb_snes_getkey with scripted reports, the way GRUB's terminal
+ * polling does.  Prints one "metric value" line per scenario:
+ *
+ *   decoder_poll_ns     getkey with no new report (the common case)
+ *   decoder_idle_ns     getkey + an unchanged idle report (chatty dongles)
+ *   decoder_input_ns    getkey + a report from a press/release/chord mix,
+ *                       including the paced macro the chord replays
+ *
+ * Each scenario gets an untimed warm-up pass, then REPEATS timed passes of
+ * ITERATIONS getkey calls; the median pass is reported.
+ *
+ *   cc -O2 -Ibench/shim bench/decoder_bench.c bench/shim/stubs.c -o decoder_bench
+ *   ./decoder_bench [ITERATIONS]
+ */
+
+#define _GNU_SOURCE
+#include <time.h>
+
+#include "../src/usb_snes_gamepad.c"
+
+#define DEFAULT_ITERATIONS  2000000
+#define REPEATS             5
+
+/*
+ * Fake clock and report source
+ */
+static grub_uint64_t fake_now_ms;
+static const grub_uint8_t *next_report;
+
+grub_uint64_t
+grub_get_time_ms (void)
+{
+    return fake_now_ms;
+}
+
+const char *
+grub_env_get (const char *name)
+{
+    /* One bound chord so the input mix also exercises macro lookup */
+    if (grub_strcmp (name, "snes_macro_l_r") == 0)
+        return "e{down}{end}";
+    return NULL;
+}
+
+grub_usb_err_t
+grub_usb_check_transfer (grub_usb_transfer_t trans __attribute__ ((unused)),
+                         grub_size_t *actual)
+{
+    struct grub_usb_snes_data *data = gamepads[0].data;
+
+    if (!next_report)
+    {
+        *actual = 0;
+        return GRUB_USB_ERR_WAIT;
+    }
+    grub_memcpy (data->report, next_report, USB_REPORT_SIZE);
+    next_report = NULL;
+    *actual = USB_REPORT_SIZE;
+    return GRUB_USB_ERR_NONE;
+}
+
+/*
+ * Scripted reports
+ */
+#define IDLE_REPORT     0x7F, 0x7F, 0x7F, 0x7F
+
+static const grub_uint8_t idle[USB_REPORT_SIZE] = { IDLE_REPORT, 0, 0, 0, 0 };
+
+static const grub_uint8_t input_mix[][USB_REPORT_SIZE] = {
+    { 0x7F, 0x00, 0x7F, 0x7F, 0, 0, 0, 0 },             /* up */
+    { IDLE_REPORT, 0, 0, 0, 0 },
+    { 0x7F, 0xFF, 0x7F, 0x7F, 0, 0, 0, 0 },             /* down */
+    { IDLE_REPORT, 0, 0, 0, 0 },
+    { IDLE_REPORT, BTN_A, 0, 0, 0 },
+    { IDLE_REPORT, 0, 0, 0, 0 },
+    { IDLE_REPORT, BTN_L, 0, 0, 0 },                    /* held back */
+    { IDLE_REPORT, BTN_L | BTN_R, 0, 0, 0 },            /* chord -> macro */
+    { IDLE_REPORT, 0, 0, 0, 0 },
+    { IDLE_REPORT, BTN_START, 0, 0, 0 },
+    { IDLE_REPORT, 0, 0, 0, 0 },
+    { 0x00, 0x7F, 0x7F, 0x7F, BTN_B, 0, 0, 0 },         /* left + B */
+    { IDLE_REPORT, 0, 0, 0, 0 },
+};
+
+#define INPUT_MIX_KEYS  9      /* keys one pass over input_mix produces */
+
+static struct grub_term_input *term;
+static unsigned long keys_seen;
+static int *key_log;
+static int key_log_size;
+
+static void
+poll_once (const grub_uint8_t *report)
+{
+    int key;
+
+    next_report = report;
+    fake_now_ms++;
+    while ((key = term->getkey (term)) != GRUB_TERM_NO_KEY)
+    {
+        if (key_log && keys_seen < (unsigned long) key_log_size)
+            key_log[keys_seen] = key;
+        keys_seen++;
+    }
+}
+
+/*
+ * Let the clock run until the macro has replayed and the keys queued
+ * behind it are out.  At 1 ms per report the L+R chord would come back
+ * before the macro's pacing emits its second key and restart it forever.
+ */
+static void
+drain_macro (void)
+{
+    struct grub_usb_snes_data *data = term->data;
+
+    while (data->macro_pos < data->macro_len)
+    {
+        fake_now_ms += data->macro_delay_ms;
+        poll_once (NULL);
+    }
+}
+
+/*
+ * One pass over input_mix must give exactly these keys, in this order
+ */
+static int
+check_input_mix (void)
+{
+    int expected[INPUT_MIX_KEYS] = {
+        key_up, key_down, key_a,
+        'e', GRUB_TERM_KEY_DOWN, GRUB_TERM_KEY_END,     /* L+R macro */
+        key_start, key_left, key_b                      /* queued behind it */
+    };
+    int got[INPUT_MIX_KEYS + 1];
+    unsigned long before = keys_seen;
+    unsigned i;
+    int n;
+
+    key_log = got;
+    key_log_size = ARRAY_SIZE (got);
+    keys_seen = 0;
+    for (i = 0; i < ARRAY_SIZE (input_mix); i++)
+        poll_once (input_mix[i]);
+    drain_macro ();
+    n = keys_seen;
+    keys_seen = before;
+    key_log = NULL;
+
+    if (n == INPUT_MIX_KEYS && grub_memcmp (got, expected, sizeof (expected)) == 0)
+        return 1;
+
+    fprintf (stderr, "input mix decoded %d keys, expected %d:", n, INPUT_MIX_KEYS);
+    for (i = 0; i < (unsigned) n && i < ARRAY_SIZE (got); i++)
+        fprintf (stderr, " %d", got[i]);
+    fprintf (stderr, "\n");
+    return 0;
+}
+
+static double
+now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double
+timed_pass (long iterations, int scenario)
+{
+    double start;
+    long i;
+
+    start = now_ns ();
+    for (i = 0; i < iterations; i++)
+    {
+        if (scenario == 0)
+            poll_once (NULL);
+        else if (scenario == 1)
+            poll_once (idle);
+        else
+        {
+            poll_once (input_mix[i % ARRAY_SIZE (input_mix)]);
+            if (i % ARRAY_SIZE (input_mix) == ARRAY_SIZE (input_mix) - 1)
+                drain_macro ();
+        }
+    }
+    return (now_ns () - start) / iterations;
+}
+
+static int
+cmp_double (const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Warm-up, then the median of REPEATS passes.  Returns the number of
+ * getkey passes over input_mix run (for the key count check).
+ */
+static long
+run (const char *metric, long iterations, int scenario)
+{
+    double ns[REPEATS];
+    long warmup = iterations / 10;
+    int r;
+
+    warmup -= warmup % ARRAY_SIZE (input_mix);
+    timed_pass (warmup, scenario);
+    for (r = 0; r < REPEATS; r++)
+        ns[r] = timed_pass (iterations, scenario);
+    qsort (ns, REPEATS, sizeof (ns[0]), cmp_double);
+
+    printf ("%s %.2f\n", metric, ns[REPEATS / 2]);
+    return (warmup + REPEATS * iterations) / ARRAY_SIZE (input_mix);
+}
+
+int
+main (int argc, char **argv)
+{
+    static struct grub_usb_desc_endp endp = { .endp_addr = 0x81 };
+    static struct grub_usb_desc_if iface = { .endpointcnt = 1 };
+    static struct grub_usb_device dev;
+    long iterations = argc > 1 ? atol (argv[1]) : DEFAULT_ITERATIONS;
+    unsigned long expected_keys;
+    long passes;
+    int i;
+
+    dev.descdev.vendorid = 0x0810;
+    dev.descdev.prodid = 0xe501;
+    dev.config[0].interf[0].descif = &iface;
+    dev.config[0].interf[0].descendp = &endp;
+
+    if (!grub_usb_snes_attach (&dev, 0, 0) || !gamepads[0].data)
+    {
+        fprintf (stderr, "attach failed\n");
+        return 1;
+    }
+    term = &gamepads[0];
+
+    /* Let the idle report calibrate before measuring */
+    for (i = 0; i < CALIB_STABLE_MS * 2; i++)
+        poll_once (idle);
+    if (!((struct grub_usb_snes_data *) term->data)->calibrated)
+    {
+        fprintf (stderr, "pad did not calibrate\n");
+        return 1;
+    }
+
+    if (!check_input_mix ())
+        return 1;
+
+    /* Whole passes only, so every pass must give all its keys */
+    iterations -= iterations % ARRAY_SIZE (input_mix);
+    if (iterations <= 0)
+        iterations = ARRAY_SIZE (input_mix);
+
+    run ("decoder_poll_ns", iterations, 0);
+    run ("decoder_idle_ns", iterations, 1);
+    if (keys_seen)
+    {
+        fprintf (stderr, "%lu keys decoded from idle reports\n", keys_seen);
+        return 1;
+    }
+    passes = run ("decoder_input_ns", iterations, 2);
+
+    expected_keys = (unsigned long) passes * INPUT_MIX_KEYS;
+    fprintf (stderr, "%lu keys decoded\n", keys_seen);
+    if (keys_seen != expected_keys)
+    {
+        fprintf (stderr, "expected %lu keys from the input mix\n", expected_keys);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""
+Power-on to decision, end to end: GRUB module vs userspace selector.
+
+Boots a prepared disk image of each approach in QEMU (SeaBIOS and OVMF),
+with the virtual pad from bench/virtual_pad.py passed through as a real USB
+device. A scripted choice is pressed once the menu is up, and the serial
+console gives the timestamps:
+
+    menu       power-on -> menu on screen
+    reaction   pad press -> menu redrawn (median over the script)
+    handoff    power-on -> target OS kernel running
+
+    sudo ./bench/e2e_qemu.py --grub-image grub.qcow2 --selector-image sel.qcow2
+    sudo ./bench/e2e_qemu.py --grub-image grub.qcow2 --firmware seabios --runs 5
+
+Preparing the images (any Linux VM with GRUB, e.g. an Ubuntu install):
+
+  both:      GRUB_TERMINAL="console serial"
+             GRUB_SERIAL_COMMAND="serial --unit=0 --speed=115200"
+             GRUB_CMDLINE_LINUX="console=tty0 console=ttyS0,115200"
+  GRUB path: run ./install.sh in the VM (usb_snes_gamepad module), keep a
+             visible menu (GRUB_TIMEOUT_STYLE=menu)
+  selector:  run boot-selector/install.sh in the VM, GRUB_TIMEOUT=0 and
+             add boot_selector.markers=ttyS0 to GRUB_CMDLINE_LINUX
+
+Serial markers: the GRUB path is timed from GRUB's own menu output and the
+kernel banner ("Linux version"); the selector writes BSEL:<EVENT> lines
+(BSEL:MENU_READY, BSEL:INPUT_DOWN, BSEL:REDRAW, BSEL:HANDOFF_LINUX).
+Images are opened with -snapshot, so runs never modify them.
+"""
+
+import os
+import re
+import sys
+import time
+import socket
+import shutil
+import argparse
+import statistics
+import subprocess
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from virtual_pad import VirtualPad  # noqa: E402
+
+OVMF_CANDIDATES = (
+    "/usr/share/ovmf/OVMF.fd",
+    "/usr/share/OVMF/OVMF.fd",
+    "/usr/share/qemu/OVMF.fd",
+    "/usr/share/edk2/ovmf/OVMF_CODE.fd",
+)
+
+# approach -> serial regexes
+MARKERS = {
+    "grub": {
+        "menu": rb"GNU GRUB",
+        # Any menu output after a press except the countdown line
+        "reaction": rb"\x1b\[7m|\x1b\[[0-9;]*H(?![^\r\n]*automatically in)",
+        "handoff": rb"Linux version",
+    },
+    "selector": {
+        "menu": rb"BSEL:MENU_READY",
+        "reaction": rb"BSEL:INPUT_\w+.*?BSEL:REDRAW",
+        "handoff": rb"BSEL:HANDOFF_\w+",
+    },
+}
+
+
+class Serial:
+    """Guest serial console on a unix socket, with arrival timestamps."""
+
+    def __init__(self, path, timeout=60.0):
+        deadline = time.monotonic() + timeout
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        while True:
+            try:
+                self.sock.connect(path)
+                break
+            except OSError:
+                if time.monotonic() > deadline:
+                    raise
+                time.sleep(0.01)
+        self.buf = b""
+        self.log = []
+
+    def wait_for(self, pattern, start, deadline):
+        # Time of the chunk that completed a match at or after offset START
+        regex = re.compile(pattern, re.S)
+        while True:
+            m = regex.search(self.buf, start)
+            if m:
+                return self._time_at(m.end()), m.end()
+            left = deadline - time.monotonic()
+            if left <= 0:
+                return None, start
+            self.sock.settimeout(left)
+            try:
+                data = self.sock.recv(65536)
+            except socket.timeout:
+                return None, start
+            if not data:
+                return None, start
+            self.buf += data
+            self.log.append((len(self.buf), time.monotonic()))
+
+    def _time_at(self, offset):
+        for end, t in self.log:
+            if end >= offset:
+                return t
+        return time.monotonic()
+
+    def close(self):
+        self.sock.close()
+
+
+def qemu_command(image, firmware, ovmf, serial_path):
+    cmd = [
+        "qemu-system-x86_64",
+        "-m", "2048",
+        "-smp", "2",
+        "-snapshot",
+        "-drive", f"file={image},if=virtio",
+        "-vga", "std",
+        "-display", "none",
+        "-monitor", "none",
+        "-serial", f"unix:{serial_path},server=on,wait=on",
+        "-usb",
+        "-device", "usb-host,vendorid=0x0810,productid=0xe501",
+    ]
+    if os.access("/dev/kvm", os.R_OK | os.W_OK):
+        cmd += ["-enable-kvm", "-cpu", "host"]
+    if firmware == "ovmf":
+        cmd += ["-bios", ovmf]
+    return cmd
+
+
+def run_once(pad, approach, image, firmware, ovmf, script, timeout, workdir):
+    serial_path = os.path.join(workdir, f"serial-{approach}-{firmware}.sock")
+    if os.path.exists(serial_path):
+        os.unlink(serial_path)
+    marks = MARKERS[approach]
+
+    with open(os.path.join(workdir, f"qemu-{approach}-{firmware}.log"), "ab") as qlog:
+        proc = subprocess.Popen(qemu_command(image, firmware, ovmf, serial_path),
+                                stdin=subprocess.DEVNULL, stdout=qlog, stderr=qlog)
+    serial = None
+    result = {"menu": None, "reaction": None, "handoff": None}
+    try:
+        # wait=on: the guest starts once the console is connected
+        serial = Serial(serial_path)
+        power_on = time.monotonic()
+        deadline = power_on + timeout
+
+        t, pos = serial.wait_for(marks["menu"], 0, deadline)
+        if t is None:
+            return result
+        result["menu"] = t - power_on
+        time.sleep(0.5)          # let the first frame finish
+
+        reactions = []
+        for action in script:
+            pos = len(serial.buf)
+            pressed = time.monotonic()
+            pad.press(action)
+            t, pos = serial.wait_for(marks["reaction"], pos, pressed + 5.0)
+            pad.release()
+            if t is not None:
+                reactions.append(t - pressed)
+            time.sleep(0.3)
+        if reactions:
+            result["reaction"] = statistics.median(reactions)
+
+        t, pos = serial.wait_for(marks["handoff"], pos, deadline)
+        if t is not None:
+            result["handoff"] = t - power_on
+        return result
+    finally:
+        if serial:
+            with open(os.path.join(workdir, f"serial-{approach}-{firmware}.log"), "ab") as f:
+                f.write(serial.buf)
+            serial.close()
+        proc.terminate()
+        try:
+            proc.wait(10)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+
+
+def fmt(value, scale=1.0, unit="s"):
+    return f"{value * scale:8.2f} {unit}" if value is not None else f"{'-':>8}   "
+
+
+def main():
+    parser = argparse.ArgumentParser(description="QEMU end-to-end boot selection benchmark")
+    parser.add_argument("--grub-image", help="Disk image with the GRUB module (install.sh)")
+    parser.add_argument("--selector-image", help="Disk image with the userspace selector (boot-selector/install.sh)")
+    parser.add_argument("--firmware", default="seabios,ovmf", help="Comma list: seabios, ovmf (default: both)")
+    parser.add_argument("--ovmf", help="OVMF firmware image (default: first found in the usual paths)")
+    parser.add_argument("--script", default="down,up,a",
+                        help="Pad actions pressed at the menu (default: down,up,a -> first entry)")
+    parser.add_argument("--runs", type=int, default=3, help="Boots per combination (default: 3)")
+    parser.add_argument("--timeout", type=float, default=180, help="Seconds per boot (default: 180)")
+    parser.add_argument("--out", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "out"),
+                        help="Directory for serial logs (default: bench/out)")
+    args = parser.parse_args()
+
+    approaches = [(a, img) for a, img in (("grub", args.grub_image), ("selector", args.selector_image)) if img]
+    if not approaches:
+        parser.error("give --grub-image and/or --selector-image")
+    if not shutil.which("qemu-system-x86_64"):
+        sys.exit("qemu-system-x86_64 not found")
+    firmwares = [f.strip() for f in args.firmware.split(",") if f.strip()]
+    ovmf = args.ovmf or next((p for p in OVMF_CANDIDATES if os.path.exists(p)), None)
+    if "ovmf" in firmwares and not ovmf:
+        print("OVMF not found (--ovmf), UEFI runs skipped")
+        firmwares.remove("ovmf")
+    script = [a.strip() for a in args.script.split(",") if a.strip()]
+    os.makedirs(args.out, exist_ok=True)
+
+    rows = []
+    with VirtualPad() as pad:
+        for approach, image in approaches:
+            for firmware in firmwares:
+                runs = []
+                for i in range(args.runs):
+                    r = run_once(pad, approach, image, firmware, ovmf, script, args.timeout, args.out)
+                    print(f"{approach:<9} {firmware:<8} run {i + 1}: menu {fmt(r['menu'])}  "
+                          f"reaction {fmt(r['reaction'], 1000, 'ms')}  handoff {fmt(r['handoff'])}")
+                    runs.append(r)
+                rows.append((approach, firmware, runs))
+
+    def median(runs, key):
+        vals = [r[key] for r in runs if r[key] is not None]
+        return statistics.median(vals) if vals else None
+
+    print("")
+    print(f"{'approach':<9} {'firmware':<8} {'menu':>11} {'reaction':>11} {'handoff':>11}  (median of {args.runs})")
+    for approach, firmware, runs in rows:
+        print(f"{approach:<9} {firmware:<8} {fmt(median(runs, 'menu'))} "
+              f"{fmt(median(runs, 'reaction'), 1000, 'ms')} {fmt(median(runs, 'handoff'))}")
+    print(f"\nSerial and QEMU logs: {args.out}")
+
+    failed = any(r["handoff"] is None for _, _, runs in rows for r in runs)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+First-press latency of the selector with and without USB tuning.
+
+The pad is the dummy_hcd HID gadget from bench/virtual_pad.py, so it goes
+through the real USB stack (usbhid polling, runtime PM). Each run starts
+the selector on a pty, leaves the pad idle long enough to autosuspend,
+presses down once and times press -> redraw.
+
+    untuned   --no-usb-tuning, pad left at power/control=auto
+    tuned     the selector pins power/control=on and sets usbhid jspoll
+
+    sudo ./bench/first_press.py
+    sudo ./bench/first_press.py --runs 20 --idle 5 --poll-ms 2
+
+"untuned" starts every run from power/control=auto with a short
+autosuspend delay, the setting laptops' power tools apply; the original
+values are put back at the end.
+"""
+
+import os
+import sys
+import time
+import signal
+import argparse
+import tempfile
+import shutil
+import subprocess
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from virtual_pad import VirtualPad  # noqa: E402
+from selector_latency import Pty, MENU_READY, HIGHLIGHT, extract_selector, percentile  # noqa: E402
+
+
+def sysfs_read(path):
+    with open(path) as f:
+        return f.read().strip()
+
+
+def sysfs_write(path, value):
+    with open(path, "w") as f:
+        f.write(value)
+
+
+def first_press(pad, selector, event, extra_args, idle):
+    pty = Pty()
+    proc = subprocess.Popen([sys.executable, selector, "--test", "--gamepad", event] + extra_args,
+                            stdin=pty.slave, stdout=pty.slave, stderr=subprocess.DEVNULL,
+                            start_new_session=True)
+    try:
+        if pty.wait_for(MENU_READY, time.monotonic() + 15) is None:
+            return None
+        pty.drain(idle)
+        t0 = time.monotonic()
+        pad.press("down", timeout=2.0)
+        t1 = pty.wait_for(HIGHLIGHT["down"], t0 + 2.0)
+        pad.release()
+        return (t1 - t0) * 1000 if t1 is not None else None
+    finally:
+        if proc.poll() is None:
+            os.killpg(proc.pid, signal.SIGINT)
+            try:
+                proc.wait(5)
+            except subprocess.TimeoutExpired:
+                os.killpg(proc.pid, signal.SIGKILL)
+        os.close(pty.master)
+        os.close(pty.slave)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Selector first-press latency, USB tuning on/off")
+    parser.add_argument("--runs", type=int, default=10, help="Runs per mode (default: 10)")
+    parser.add_argument("--idle", type=float, default=3.0, help="Idle seconds before the press (default: 3)")
+    parser.add_argument("--poll-ms", type=int, default=1, help="usbhid interval for the tuned runs (default: 1)")
+    parser.add_argument("--autosuspend-ms", type=int, default=500,
+                        help="Autosuspend delay for the untuned runs (default: 500)")
+    parser.add_argument("--selector", help="selector.py to run (default: extracted from the installer)")
+    parser.add_argument("--metrics", action="store_true", help="Print metric lines for bench/run.sh")
+    args = parser.parse_args()
+
+    tmpdir = tempfile.mkdtemp(prefix="bsel-first-")
+    selector = args.selector or extract_selector(tmpdir)
+    results = {}
+
+    with VirtualPad() as pad:
+        usbdev = pad.usb_sysfs()
+        if not usbdev:
+            sys.exit("virtual pad did not enumerate on the host")
+        control = os.path.join(usbdev, "power", "control")
+        delay = os.path.join(usbdev, "power", "autosuspend_delay_ms")
+        saved = (sysfs_read(control), sysfs_read(delay))
+        print(f"pad: {usbdev} (power/control={saved[0]}, autosuspend={saved[1]} ms)")
+
+        modes = (("untuned", ["--no-usb-tuning"]), ("tuned", ["--usb-poll-ms", str(args.poll_ms)]))
+        try:
+            for mode, extra in modes:
+                samples = []
+                for _ in range(args.runs):
+                    sysfs_write(delay, str(args.autosuspend_ms))
+                    sysfs_write(control, "auto")
+                    event = pad.event_device()
+                    if not event:
+                        sys.exit("no input device for the virtual pad")
+                    ms = first_press(pad, selector, event, extra, args.idle)
+                    if ms is not None:
+                        samples.append(ms)
+                samples.sort()
+                results[mode] = samples
+                print(f"{mode:<8} n={len(samples):<3} p50={percentile(samples, 50):7.2f} ms  "
+                      f"max={samples[-1] if samples else float('nan'):7.2f} ms")
+        finally:
+            sysfs_write(delay, saved[1])
+            sysfs_write(control, saved[0])
+            shutil.rmtree(tmpdir, ignore_errors=True)
+
+    if args.metrics:
+        for mode, samples in results.items():
+            if samples:
+                print(f"first_press_{mode}_p50_ms {percentile(samples, 50):.2f}")
+    return 0 if all(results.get(m) for m in ("untuned", "tuned")) else 1
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)
@@ -0,0 +1,128 @@
+#!/bin/bash
+# Run all benchmarks, write one JSON result file and compare it against
+# bench/baseline.json (exit 1 on regression)
+#
+#   ./bench/run.sh                        # or: make bench
+#   OUT=/tmp/b ./bench/run.sh             # results in /tmp/b/results.json
+#   SAMPLES=50 LOAD=4 ./bench/run.sh      # shorter selector runs
+#   UPDATE_BASELINE=1 ./bench/run.sh      # accept the results as new baseline
+#   FIRST_PRESS=1 ./bench/run.sh          # add first-press latency (dummy_hcd)
+#
+# Selector latency needs root, /dev/uinput and python3-evdev; without them
+# those metrics are skipped, not failed. They have no baseline until one is
+# recorded on such a machine (UPDATE_BASELINE=1); until then they are
+# reported as new.
+
+set -eo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+OUT="${OUT:-$SCRIPT_DIR/out}"
+CC="${CC:-cc}"
+ITERATIONS="${ITERATIONS:-2000000}"
+SAMPLES="${SAMPLES:-100}"
+LOAD="${LOAD:-$(nproc)}"
+BASELINE="$SCRIPT_DIR/baseline.json"
+METRICS="$OUT/metrics.txt"
+RESULTS="$OUT/results.json"
+
+mkdir -p "$OUT"
+: > "$METRICS"
+
+echo "=== GRUB Boot Selector benchmarks ==="
+
+# Build time: host compile of each GRUB module against the shim, best of 3
+echo ""
+echo "--- Build (host compile, -O2) ---"
+for mod in usb_snes_gamepad net_choice boot_schedule; do
+    best=""
+    for _ in 1 2 3; do
+        start=$(date +%s%N)
+        "$CC" -std=gnu99 -O2 -I"$SCRIPT_DIR/shim" -c "$PROJECT_DIR/src/$mod.c" -o "$OUT/$mod.o"
+        ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "build_${mod}_ms $best" | tee -a "$METRICS"
+done
+
+# GRUB decode path
+echo ""
+echo "--- Decoder (usb_snes_gamepad.c on the host) ---"
+"$CC" -std=gnu99 -O2 -I"$SCRIPT_DIR/shim" \
+    "$SCRIPT_DIR/decoder_bench.c" "$SCRIPT_DIR/shim/stubs.c" -o "$OUT/decoder_bench"
+"$OUT/decoder_bench" "$ITERATIONS" | grep '^decoder_' | tee -a "$METRICS"
+
+# Selector event loop and device discovery
+echo ""
+echo "--- Selector (uinput pad, pty) ---"
+if [ "$(id -u)" -ne 0 ]; then
+    echo "skipped: needs root"
+elif [ ! -w /dev/uinput ]; then
+    echo "skipped: /dev/uinput not available (modprobe uinput)"
+elif ! python3 -c "import evdev" >/dev/null 2>&1; then
+    echo "skipped: python3-evdev not installed"
+else
+    python3 "$SCRIPT_DIR/selector_latency.py" --samples "$SAMPLES" \
+        --metrics selector | tee "$OUT/selector.txt"
+    python3 "$SCRIPT_DIR/selector_latency.py" --samples "$SAMPLES" --load "$LOAD" \
+        --metrics selector_load | tee "$OUT/selector_load.txt"
+    grep -h '^selector' "$OUT/selector.txt" "$OUT/selector_load.txt" >> "$METRICS"
+fi
+
+# First press after idle, USB tuning off/on (slow: opt in with FIRST_PRESS=1)
+if [ -n "$FIRST_PRESS" ]; then
+    echo ""
+    echo "--- First press (dummy_hcd pad, USB tuning off/on) ---"
+    if [ "$(id -u)" -ne 0 ]; then
+        echo "skipped: needs root"
+    else
+        python3 "$SCRIPT_DIR/first_press.py" --metrics | tee "$OUT/first_press.txt" || true
+        grep -h '^first_press_' "$OUT/first_press.txt" >> "$METRICS" || true
+    fi
+fi
+
+# One JSON file with the metrics and where they were measured
+python3 - "$METRICS" "$RESULTS" "$PROJECT_DIR" << 'PYEOF'
+import json, os, platform, subprocess, sys, time
+
+metrics_path, results_path, project = sys.argv[1:4]
+metrics = {}
+with open(metrics_path) as f:
+    for line in f:
+        name, value = line.split()
+        metrics[name] = float(value)
+
+cpu = ""
+try:
+    with open("/proc/cpuinfo") as f:
+        cpu = next((l.split(":", 1)[1].strip() for l in f if l.startswith("model name")), "")
+except OSError:
+    pass
+rev = subprocess.run(["git", "-C", project, "rev-parse", "--short", "HEAD"],
+                     capture_output=True, text=True).stdout.strip()
+
+with open(results_path, "w") as f:
+    json.dump({
+        "time": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        "git": rev,
+        "host": platform.node(),
+        "kernel": platform.release(),
+        "cpu": cpu,
+        "cpus": os.cpu_count(),
+        "metrics": metrics,
+    }, f, indent=2, sort_keys=True)
+    f.write("\n")
+PYEOF
+echo ""
+echo "Results: $RESULTS"
+
+echo ""
+echo "--- Compare with baseline ---"
+if [ -n "$UPDATE_BASELINE" ]; then
+    python3 "$SCRIPT_DIR/compare.py" --update "$RESULTS" "$BASELINE"
+else
+    python3 "$SCRIPT_DIR/compare.py" "$RESULTS" "$BASELINE"
+fi
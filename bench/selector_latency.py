@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+Press-to-redraw latency of the userspace selector under boot-like load.
+
+A virtual pad (uinput) presses down/up alternately; the selector runs in
+--test mode on a pty, and the latency is the time from the press until the
+pty shows the menu with the new entry highlighted.
+
+    sudo ./bench/selector_latency.py                     # idle machine
+    sudo ./bench/selector_latency.py --load 8            # 8 CPU + 8 I/O hogs
+    sudo ./bench/selector_latency.py --load 8 --scope    # inside boot-selector.slice
+
+--load uses stress-ng when installed, otherwise plain Python hogs (CPU
+spinners and fsync writers). Needs root (uinput, /var/log) and python3-evdev.
+
+--metrics PREFIX also prints "PREFIX_startup_ms / _p50_ms / _p99_ms" lines
+for bench/run.sh; startup is launch to first menu (imports, isolation,
+device discovery).
+"""
+
+import os
+import re
+import math
+import sys
+import time
+import fcntl
+import random
+import select
+import shutil
+import signal
+import struct
+import termios
+import argparse
+import tempfile
+import subprocess
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+INSTALLER = os.path.join(HERE, "..", "boot-selector", "install.sh")
+
+MENU_READY = b"SELECTOR DE ARRANQUE"
+HIGHLIGHT = {"down": b">> WINDOWS <<", "up": b">> UBUNTU LINUX <<"}
+
+
+def extract_selector(dest):
+    # selector.py lives in a heredoc of the installer
+    with open(INSTALLER) as f:
+        text = f.read()
+    m = re.search(r"cat > /opt/boot-selector/selector\.py << 'PYEOF'\n(.*?)\nPYEOF\n", text, re.S)
+    if not m:
+        sys.exit("selector.py heredoc not found in boot-selector/install.sh")
+    path = os.path.join(dest, "selector.py")
+    with open(path, "w") as f:
+        f.write(m.group(1) + "\n")
+    return path
+
+
+def hog_cpu():
+    while True:
+        pass
+
+
+def hog_io(path):
+    block = os.urandom(1 << 20)
+    while True:
+        with open(path, "wb") as f:
+            for _ in range(64):
+                f.write(block)
+                f.flush()
+                os.fsync(f.fileno())
+
+
+def start_load(n, tmpdir, duration):
+    if n <= 0:
+        return []
+    if shutil.which("stress-ng"):
+        cmd = ["stress-ng", "--cpu", str(n), "--hdd", str(n), "--io", str(max(1, n // 2)),
+               "--temp-path", tmpdir, "--timeout", f"{duration}s", "--quiet"]
+        print(f"load: {' '.join(cmd)}")
+        return [subprocess.Popen(cmd)]
+    print(f"load: stress-ng not found, {n} CPU + {n} I/O Python hogs")
+    procs = []
+    for i in range(2 * n):
+        pid = os.fork()
+        if pid == 0:
+            try:
+                if i < n:
+                    hog_cpu()
+                else:
+                    hog_io(os.path.join(tmpdir, f"hog{i}"))
+            finally:
+                os._exit(0)
+        procs.append(pid)
+    return procs
+
+
+def stop_load(procs):
+    for p in procs:
+        if isinstance(p, int):
+            try:
+                os.kill(p, signal.SIGKILL)
+                os.waitpid(p, 0)
+            except OSError:
+                pass
+        else:
+            p.terminate()
+            p.wait()
+
+
+class Pty:
+    def __init__(self):
+        self.master, self.slave = os.openpty()
+        fcntl.ioctl(self.slave, termios.TIOCSWINSZ, struct.pack("HHHH", 24, 80, 0, 0))
+        self.buf = b""
+
+    def wait_for(self, marker, deadline):
+        # Keep draining so the selector never blocks on a full pty
+        while marker not in self.buf:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                return None
+            r, _, _ = select.select([self.master], [], [], left)
+            if r:
+                try:
+                    self.buf += os.read(self.master, 65536)
+                except OSError:
+                    return None
+        return time.monotonic()
+
+    def drain(self, seconds):
+        self.wait_for(b"\0never\0", time.monotonic() + seconds)
+        self.buf = b""
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return float("nan")
+    # Nearest rank
+    k = max(1, math.ceil(p / 100.0 * len(sorted_vals)))
+    return sorted_vals[k - 1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Selector press-to-redraw latency benchmark")
+    parser.add_argument("--samples", type=int, default=200, help="Presses to measure (default: 200)")
+    parser.add_argument("--load", type=int, default=0, metavar="N", help="N CPU + N I/O load workers")
+    parser.add_argument("--scope", action="store_true", help="Run the selector in boot-selector.slice via systemd-run")
+    parser.add_argument("--selector", help="selector.py to run (default: extracted from the installer)")
+    parser.add_argument("--trace", help="Also write the selector's BOOT_SELECTOR_TRACE here")
+    parser.add_argument("--metrics", metavar="PREFIX", help="Print metric lines for bench/run.sh")
+    args = parser.parse_args()
+
+    try:
+        from evdev import UInput, ecodes
+    except ImportError:
+        sys.exit("python3-evdev is required")
+
+    tmpdir = tempfile.mkdtemp(prefix="bsel-bench-")
+    selector = args.selector or extract_selector(tmpdir)
+
+    caps = {ecodes.EV_KEY: [ecodes.BTN_DPAD_UP, ecodes.BTN_DPAD_DOWN, ecodes.BTN_SOUTH, ecodes.BTN_START]}
+    try:
+        ui = UInput(caps, name="Boot Selector Bench Pad")
+    except Exception as e:
+        sys.exit(f"uinput not available: {e}")
+    keys = {"down": ecodes.BTN_DPAD_DOWN, "up": ecodes.BTN_DPAD_UP}
+
+    cmd = [sys.executable, selector, "--test", "--gamepad", ui.device.path]
+    if args.scope:
+        cmd = ["systemd-run", "--scope", "--quiet", "--collect", "--slice=boot-selector.slice"] + cmd
+    env = dict(os.environ)
+    if args.trace:
+        env["BOOT_SELECTOR_TRACE"] = args.trace
+
+    load = start_load(args.load, tmpdir, 60 + args.samples)
+    pty = Pty()
+    launched = time.monotonic()
+    proc = subprocess.Popen(cmd, stdin=pty.slave, stdout=pty.slave, stderr=subprocess.DEVNULL,
+                            env=env, start_new_session=True)
+    latencies = []
+    timeouts = 0
+    try:
+        ready = pty.wait_for(MENU_READY, time.monotonic() + 15)
+        if ready is None:
+            sys.exit("selector did not draw its menu")
+        startup_ms = (ready - launched) * 1000
+        pty.drain(0.3)
+
+        for i in range(args.samples):
+            action = "down" if i % 2 == 0 else "up"
+            pty.drain(random.uniform(0.05, 0.15))
+            ui.write(ecodes.EV_KEY, keys[action], 1)
+            t0 = time.monotonic()
+            ui.syn()
+            t1 = pty.wait_for(HIGHLIGHT[action], t0 + 2.0)
+            ui.write(ecodes.EV_KEY, keys[action], 0)
+            ui.syn()
+            if t1 is None:
+                timeouts += 1
+            else:
+                latencies.append((t1 - t0) * 1000)
+            if proc.poll() is not None:
+                sys.exit("selector exited during the run")
+    finally:
+        if proc.poll() is None:
+            os.killpg(proc.pid, signal.SIGINT)
+            try:
+                proc.wait(3)
+            except subprocess.TimeoutExpired:
+                os.killpg(proc.pid, signal.SIGKILL)
+        stop_load(load)
+        ui.close()
+        shutil.rmtree(tmpdir, ignore_errors=True)
+
+    latencies.sort()
+    print(f"samples={len(latencies)} timeouts={timeouts} load={args.load} scope={int(args.scope)}")
+    print("startup ms: %.1f" % startup_ms)
+    print("press-to-redraw ms: p50=%.2f p90=%.2f p99=%.2f max=%.2f" % (
+        percentile(latencies, 50), percentile(latencies, 90),
+        percentile(latencies, 99), latencies[-1] if latencies else float("nan")))
+    if args.metrics:
+        print(f"{args.metrics}_startup_ms {startup_ms:.2f}")
+        if latencies:
+            print(f"{args.metrics}_p50_ms {percentile(latencies, 50):.2f}")
+            print(f"{args.metrics}_p99_ms {percentile(latencies, 99):.2f}")
+    return 1 if timeouts else 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)
@@ -0,0 +1,8 @@
+/* Host-side stand-in for <grub/datetime.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_DATETIME_H
+#define SHIM_GRUB_DATETIME_H 1
+#include <grub/types.h>
+#include <grub/err.h>
+struct grub_datetime { grub_uint16_t year; grub_uint8_t month, day, hour, minute, second; };
+grub_err_t grub_get_datetime (struct grub_datetime *datetime);
+#endif
@@ -0,0 +1,8 @@
+/* Host-side stand-in for <grub/dl.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_DL_H
+#define SHIM_GRUB_DL_H 1
+#include <grub/types.h>
+#define GRUB_MOD_LICENSE(x)
+#define GRUB_MOD_INIT(name) void grub_mod_init_##name (void); void grub_mod_init_##name (void)
+#define GRUB_MOD_FINI(name) void grub_mod_fini_##name (void); void grub_mod_fini_##name (void)
+#endif
@@ -0,0 +1,7 @@
+/* Host-side stand-in for <grub/env.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_ENV_H
+#define SHIM_GRUB_ENV_H 1
+#include <grub/err.h>
+const char *grub_env_get (const char *name);
+grub_err_t grub_env_set (const char *name, const char *val);
+#endif
@@ -0,0 +1,9 @@
+/* Host-side stand-in for <grub/err.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_ERR_H
+#define SHIM_GRUB_ERR_H 1
+typedef enum { GRUB_ERR_NONE = 0, GRUB_ERR_OUT_OF_MEMORY, GRUB_ERR_BAD_ARGUMENT,
+               GRUB_ERR_TIMEOUT, GRUB_ERR_IO, GRUB_ERR_NET_NO_ANSWER } grub_err_t;
+extern grub_err_t grub_errno;
+grub_err_t grub_error (grub_err_t n, const char *fmt, ...);
+void grub_print_error (void);
+#endif
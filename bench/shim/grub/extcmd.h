@@ -0,0 +1,17 @@
+/* Host-side stand-in for <grub/extcmd.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_EXTCMD_H
+#define SHIM_GRUB_EXTCMD_H 1
+#include <grub/err.h>
+enum grub_arg_type { ARG_TYPE_NONE, ARG_TYPE_STRING, ARG_TYPE_INT };
+struct grub_arg_option { const char *longarg; int shortarg; int flags;
+                         const char *doc; const char *arg; enum grub_arg_type type; };
+struct grub_arg_list { int set; union { char *arg; char **args; }; };
+struct grub_extcmd_context { struct grub_arg_list *state; };
+typedef struct grub_extcmd_context *grub_extcmd_context_t;
+typedef struct grub_extcmd *grub_extcmd_t;
+typedef grub_err_t (*grub_extcmd_func_t) (grub_extcmd_context_t ctxt, int argc, char **args);
+grub_extcmd_t grub_register_extcmd (const char *name, grub_extcmd_func_t func, unsigned flags,
+                                    const char *summary, const char *description,
+                                    const struct grub_arg_option *parser);
+void grub_unregister_extcmd (grub_extcmd_t cmd);
+#endif
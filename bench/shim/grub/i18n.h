@@ -0,0 +1,8 @@
+/* Host-side stand-in for <grub/i18n.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_I18N_H
+#define SHIM_GRUB_I18N_H 1
+#ifndef N_
+#define N_(s) s
+#endif
+#define _(s) s
+#endif
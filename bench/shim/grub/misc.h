@@ -0,0 +1,32 @@
+/* Host-side stand-in for <grub/misc.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_MISC_H
+#define SHIM_GRUB_MISC_H 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <grub/types.h>
+#include <grub/err.h>
+#define grub_dprintf(cond, ...) ((void) 0)
+#define grub_printf printf
+#define grub_memcpy memcpy
+#define grub_memset memset
+#define grub_memcmp memcmp
+#define grub_strlen strlen
+#define grub_strcmp strcmp
+#define grub_strncmp strncmp
+#define grub_strchr strchr
+#define grub_strstr strstr
+#define grub_strdup strdup
+#define grub_malloc malloc
+#define grub_zalloc(n) calloc (1, (n))
+#define grub_free free
+#define grub_isdigit isdigit
+#define grub_isspace isspace
+#define grub_tolower tolower
+#define grub_snprintf snprintf
+#define N_(s) s
+char *grub_xasprintf (const char *fmt, ...);
+unsigned long grub_strtoul (const char *str, const char **end, int base);
+long grub_strtol (const char *str, const char **end, int base);
+#endif
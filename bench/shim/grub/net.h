@@ -0,0 +1,12 @@
+/* Host-side stand-in for <grub/net.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_NET_H
+#define SHIM_GRUB_NET_H 1
+#include <grub/types.h>
+#include <grub/err.h>
+#define GRUB_NET_MAX_LINK_HEADER_SIZE 64
+#define GRUB_NET_UDP_HEADER_SIZE 8
+#define GRUB_NET_OUR_MAX_IP_HEADER_SIZE 40
+typedef struct { int type; grub_uint32_t ipv4; } grub_net_network_level_address_t;
+grub_err_t grub_net_resolve_address (const char *name, grub_net_network_level_address_t *addr);
+void grub_net_poll_cards (unsigned time, int *stop_condition);
+#endif
@@ -0,0 +1,11 @@
+/* Host-side stand-in for <grub/net/netbuff.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_NETBUFF_H
+#define SHIM_GRUB_NETBUFF_H 1
+#include <grub/types.h>
+#include <grub/err.h>
+struct grub_net_buff { grub_uint8_t *head, *data, *tail, *end; };
+struct grub_net_buff *grub_netbuff_alloc (grub_size_t len);
+grub_err_t grub_netbuff_reserve (struct grub_net_buff *nb, grub_size_t len);
+grub_err_t grub_netbuff_put (struct grub_net_buff *nb, grub_size_t len);
+grub_err_t grub_netbuff_free (struct grub_net_buff *nb);
+#endif
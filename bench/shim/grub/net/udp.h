@@ -0,0 +1,12 @@
+/* Host-side stand-in for <grub/net/udp.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_NET_UDP_H
+#define SHIM_GRUB_NET_UDP_H 1
+#include <grub/net.h>
+#include <grub/net/netbuff.h>
+typedef struct grub_net_udp_socket *grub_net_udp_socket_t;
+grub_net_udp_socket_t grub_net_udp_open (grub_net_network_level_address_t addr, grub_uint16_t out_port,
+    grub_err_t (*recv_hook) (grub_net_udp_socket_t sock, struct grub_net_buff *nb, void *data),
+    void *recv_hook_data);
+void grub_net_udp_close (grub_net_udp_socket_t sock);
+grub_err_t grub_net_send_udp_packet (const grub_net_udp_socket_t socket, struct grub_net_buff *nb);
+#endif
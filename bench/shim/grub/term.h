@@ -0,0 +1,33 @@
+/* Host-side stand-in for <grub/term.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_TERM_H
+#define SHIM_GRUB_TERM_H 1
+#include <grub/types.h>
+#define GRUB_TERM_NO_KEY        0
+#define GRUB_TERM_EXTENDED      0x00800000
+#define GRUB_TERM_CTRL          0x02000000
+#define GRUB_TERM_KEY_LEFT      (GRUB_TERM_EXTENDED | 0x4b)
+#define GRUB_TERM_KEY_RIGHT     (GRUB_TERM_EXTENDED | 0x4d)
+#define GRUB_TERM_KEY_UP        (GRUB_TERM_EXTENDED | 0x48)
+#define GRUB_TERM_KEY_DOWN      (GRUB_TERM_EXTENDED | 0x50)
+#define GRUB_TERM_KEY_HOME      (GRUB_TERM_EXTENDED | 0x47)
+#define GRUB_TERM_KEY_END       (GRUB_TERM_EXTENDED | 0x4f)
+#define GRUB_TERM_KEY_DC        (GRUB_TERM_EXTENDED | 0x53)
+#define GRUB_TERM_KEY_PPAGE     (GRUB_TERM_EXTENDED | 0x49)
+#define GRUB_TERM_KEY_NPAGE     (GRUB_TERM_EXTENDED | 0x51)
+#define GRUB_TERM_KEY_F10       (GRUB_TERM_EXTENDED | 0x44)
+#define GRUB_TERM_ESC           '\e'
+#define GRUB_TERM_TAB           '\t'
+#define GRUB_TERM_BACKSPACE     '\b'
+struct grub_term_input
+{
+  struct grub_term_input *next;
+  struct grub_term_input **prev;
+  const char *name;
+  int (*getkey) (struct grub_term_input *term);
+  int (*getkeystatus) (struct grub_term_input *term);
+  void *data;
+};
+void grub_term_register_input_active (const char *name, struct grub_term_input *term);
+void grub_term_unregister_input (struct grub_term_input *term);
+int grub_getkey_noblock (void);
+#endif
@@ -0,0 +1,7 @@
+/* Host-side stand-in for <grub/time.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_TIME_H
+#define SHIM_GRUB_TIME_H 1
+#include <grub/types.h>
+grub_uint64_t grub_get_time_ms (void);
+void grub_millisleep (grub_uint32_t ms);
+#endif
@@ -0,0 +1,15 @@
+/* Host-side stand-in for <grub/types.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_TYPES_H
+#define SHIM_GRUB_TYPES_H 1
+#include <stdint.h>
+#include <stddef.h>
+typedef uint8_t grub_uint8_t;
+typedef uint16_t grub_uint16_t;
+typedef uint32_t grub_uint32_t;
+typedef uint64_t grub_uint64_t;
+typedef int32_t grub_int32_t;
+typedef int64_t grub_int64_t;
+typedef size_t grub_size_t;
+typedef long grub_ssize_t;
+#define ARRAY_SIZE(a) (sizeof (a) / sizeof ((a)[0]))
+#endif
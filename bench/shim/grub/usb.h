@@ -0,0 +1,46 @@
+/* Host-side stand-in for <grub/usb.h>, just what the src/ modules use (bench only) */
+#ifndef SHIM_GRUB_USB_H
+#define SHIM_GRUB_USB_H 1
+#include <grub/types.h>
+#include <grub/err.h>
+typedef enum { GRUB_USB_ERR_NONE, GRUB_USB_ERR_WAIT, GRUB_USB_ERR_INTERNAL,
+               GRUB_USB_ERR_STALL, GRUB_USB_ERR_TIMEOUT } grub_usb_err_t;
+typedef enum { GRUB_USB_EP_CONTROL, GRUB_USB_EP_ISOCHRONOUS, GRUB_USB_EP_BULK,
+               GRUB_USB_EP_INTERRUPT } grub_transfer_type_t;
+#define GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT 0x21
+#define GRUB_USB_CLASS_HID 3
+struct grub_usb_desc_endp { grub_uint8_t length, type, endp_addr, attrib;
+                            grub_uint16_t maxpacket; grub_uint8_t interval; };
+struct grub_usb_desc_if { grub_uint8_t length, type, ifnum, altsetting, endpointcnt,
+                          class, subclass, protocol, ifdesc; };
+struct grub_usb_desc_device { grub_uint16_t vendorid, prodid; };
+struct grub_usb_device;
+typedef struct grub_usb_device *grub_usb_device_t;
+struct grub_usb_interface {
+  struct grub_usb_desc_if *descif;
+  struct grub_usb_desc_endp *descendp;
+  void (*detach_hook) (grub_usb_device_t dev, int config, int interface);
+};
+struct grub_usb_configuration { struct grub_usb_interface interf[32]; };
+struct grub_usb_device {
+  struct grub_usb_desc_device descdev;
+  struct grub_usb_configuration config[8];
+};
+typedef struct grub_usb_transfer *grub_usb_transfer_t;
+struct grub_usb_attach_desc {
+  struct grub_usb_attach_desc *next, **prev;
+  int class;
+  int (*hook) (grub_usb_device_t usbdev, int configno, int interfno);
+};
+grub_transfer_type_t grub_usb_get_ep_type (struct grub_usb_desc_endp *ep);
+grub_usb_err_t grub_usb_check_transfer (grub_usb_transfer_t trans, grub_size_t *actual);
+grub_usb_transfer_t grub_usb_bulk_read_background (grub_usb_device_t dev,
+    struct grub_usb_desc_endp *endpoint, grub_size_t size, void *data);
+void grub_usb_cancel_transfer (grub_usb_transfer_t trans);
+grub_usb_err_t grub_usb_set_configuration (grub_usb_device_t dev, int configuration);
+grub_usb_err_t grub_usb_control_msg (grub_usb_device_t dev, grub_uint8_t reqtype,
+    grub_uint8_t request, grub_uint16_t value, grub_uint16_t index,
+    grub_size_t size, char *data);
+void grub_usb_register_attach_hook_class (struct grub_usb_attach_desc *desc);
+void grub_usb_unregister_attach_hook_class (struct grub_usb_attach_desc *desc);
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Host-side stubs for the GRUB functions src/usb_snes_gamepad.c calls
+ * outside its hot path.  The bench supplies the ones it drives itself:
+ * grub_usb_check_transfer, grub_get_time_ms and grub_env_get.
+ */
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <grub/misc.h>
+#include <grub/term.h>
+#include <grub/usb.h>
+#include <grub/command.h>
+
+grub_err_t grub_errno;
+
+grub_err_t
+grub_error (grub_err_t n, const char *fmt __attribute__ ((unused)), ...)
+{
+    grub_errno = n;
+    return n;
+}
+
+void
+grub_print_error (void)
+{
+}
+
+char *
+grub_xasprintf (const char *fmt, ...)
+{
+    va_list ap;
+    char *s;
+
+    va_start (ap, fmt);
+    if (vasprintf (&s, fmt, ap) < 0)
+        s = NULL;
+    va_end (ap);
+    return s;
+}
+
+unsigned long
+grub_strtoul (const char *str, const char **end, int base)
+{
+    return strtoul (str, (char **) end, base);
+}
+
+long
+grub_strtol (const char *str, const char **end, int base)
+{
+    return strtol (str, (char **) end, base);
+}
+
+grub_transfer_type_t
+grub_usb_get_ep_type (struct grub_usb_desc_endp *ep __attribute__ ((unused)))
+{
+    return GRUB_USB_EP_INTERRUPT;
+}
+
+grub_usb_transfer_t
+grub_usb_bulk_read_background (grub_usb_device_t dev __attribute__ ((unused)),
+                               struct grub_usb_desc_endp *endpoint __attribute__ ((unused)),
+                               grub_size_t size __attribute__ ((unused)),
+                               void *data __attribute__ ((unused)))
+{
+    return (grub_usb_transfer_t) 1;
+}
+
+void
+grub_usb_cancel_transfer (grub_usb_transfer_t trans __attribute__ ((unused)))
+{
+}
+
+grub_usb_err_t
+grub_usb_set_configuration (grub_usb_device_t dev __attribute__ ((unused)),
+                            int configuration __attribute__ ((unused)))
+{
+    return GRUB_USB_ERR_NONE;
+}
+
+grub_usb_err_t
+grub_usb_control_msg (grub_usb_device_t dev __attribute__ ((unused)),
+                      grub_uint8_t reqtype __attribute__ ((unused)),
+                      grub_uint8_t request __attribute__ ((unused)),
+                      grub_uint16_t value __attribute__ ((unused)),
+                      grub_uint16_t index __attribute__ ((unused)),
+                      grub_size_t size __attribute__ ((unused)),
+                      char *data __attribute__ ((unused)))
+{
+    return GRUB_USB_ERR_NONE;
+}
+
+void
+grub_usb_register_attach_hook_class (struct grub_usb_attach_desc *desc __attribute__ ((unused)))
+{
+}
+
+void
+grub_usb_unregister_attach_hook_class (struct grub_usb_attach_desc *desc __attribute__ ((unused)))
+{
+}
+
+void
+grub_term_register_input_active (const char *name __attribute__ ((unused)),
+                                 struct grub_term_input *term __attribute__ ((unused)))
+{
+}
+
+void
+grub_term_unregister_input (struct grub_term_input *term __attribute__ ((unused)))
+{
+}
+
+grub_command_t
+grub_register_command (const char *name __attribute__ ((unused)),
+                       grub_command_func_t func __attribute__ ((unused)),
+                       const char *summary __attribute__ ((unused)),
+                       const char *description __attribute__ ((unused)))
+{
+    return (grub_command_t) 1;
+}
+
+void
+grub_unregister_command (grub_command_t cmd __attribute__ ((unused)))
+{
+}
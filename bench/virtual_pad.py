@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+Virtual SNES pad: a USB HID gadget on dummy_hcd, driven from Python.
+
+The gadget enumerates on the host like a real pad (0810:e501, same 8-byte
+report as src/usb_snes_gamepad.c decodes), so it can be read by usbhid /
+evdev on the host or handed to a QEMU guest with
+`-device usb-host,vendorid=0x0810,productid=0xe501`.
+
+Needs root and a kernel with libcomposite, usb_f_hid and dummy_hcd.
+
+    sudo ./bench/virtual_pad.py          # then type: up, down, a, start, quit
+
+    from virtual_pad import VirtualPad
+    with VirtualPad() as pad:
+        pad.press("down"); pad.release()
+"""
+
+import os
+import sys
+import glob
+import time
+import select
+import subprocess
+
+CONFIGFS = "/sys/kernel/config/usb_gadget"
+GADGET = "bsel_pad"
+PRODUCT = "Boot Selector Virtual Pad"
+
+# X, Y, Z, Rz (8 bit), 8 buttons, 3 bytes padding = the generic SNES report.
+# Joystick usage like 0810:e501 itself: usbhid only applies jspoll to
+# Joystick collections, so bench/first_press.py can measure it
+REPORT_DESC = bytes([
+    0x05, 0x01,         # Usage Page (Generic Desktop)
+    0x09, 0x04,         # Usage (Joystick)
+    0xA1, 0x01,         # Collection (Application)
+    0x15, 0x00,         #   Logical Minimum (0)
+    0x26, 0xFF, 0x00,   #   Logical Maximum (255)
+    0x75, 0x08,         #   Report Size (8)
+    0x95, 0x04,         #   Report Count (4)
+    0x09, 0x30,         #   Usage (X)
+    0x09, 0x31,         #   Usage (Y)
+    0x09, 0x32,         #   Usage (Z)
+    0x09, 0x35,         #   Usage (Rz)
+    0x81, 0x02,         #   Input (Data, Var, Abs)
+    0x05, 0x09,         #   Usage Page (Button)
+    0x19, 0x01,         #   Usage Minimum (1)
+    0x29, 0x08,         #   Usage Maximum (8)
+    0x15, 0x00,         #   Logical Minimum (0)
+    0x25, 0x01,         #   Logical Maximum (1)
+    0x75, 0x01,         #   Report Size (1)
+    0x95, 0x08,         #   Report Count (8)
+    0x81, 0x02,         #   Input (Data, Var, Abs)
+    0x75, 0x08,         #   Report Size (8)
+    0x95, 0x03,         #   Report Count (3)
+    0x81, 0x03,         #   Input (Const)
+    0xC0,               # End Collection
+])
+
+# Byte 4 bits, as in src/usb_snes_gamepad.c
+BUTTONS = {"x": 0x01, "a": 0x02, "b": 0x04, "y": 0x08,
+           "l": 0x10, "r": 0x20, "select": 0x40, "start": 0x80}
+AXES = {"up": (0x7F, 0x00), "down": (0x7F, 0xFF), "left": (0x00, 0x7F), "right": (0xFF, 0x7F)}
+
+
+def _write(path, value):
+    with open(path, "wb" if isinstance(value, bytes) else "w") as f:
+        f.write(value)
+
+
+class VirtualPad:
+    def __init__(self, vid=0x0810, pid=0xe501):
+        self.vid = vid
+        self.pid = pid
+        self.root = os.path.join(CONFIGFS, GADGET)
+        self.fd = None
+
+    def __enter__(self):
+        self.create()
+        return self
+
+    def __exit__(self, *exc):
+        self.destroy()
+
+    def create(self):
+        for mod in ("libcomposite", "usb_f_hid", "dummy_hcd"):
+            subprocess.run(["modprobe", mod], check=False, stderr=subprocess.DEVNULL)
+        if os.path.exists(self.root):
+            self.destroy()
+
+        r = self.root
+        os.makedirs(os.path.join(r, "strings/0x409"))
+        _write(f"{r}/idVendor", f"0x{self.vid:04x}")
+        _write(f"{r}/idProduct", f"0x{self.pid:04x}")
+        _write(f"{r}/bcdUSB", "0x0200")
+        _write(f"{r}/strings/0x409/manufacturer", "grub-boot-selector")
+        _write(f"{r}/strings/0x409/product", PRODUCT)
+        _write(f"{r}/strings/0x409/serialnumber", "bench")
+        if os.path.exists(f"{r}/max_speed"):
+            # Full speed like real SNES pads (and reachable from UHCI/OHCI)
+            _write(f"{r}/max_speed", "full-speed")
+
+        fn = f"{r}/functions/hid.usb0"
+        os.makedirs(fn)
+        _write(f"{fn}/protocol", "0")
+        _write(f"{fn}/subclass", "0")
+        _write(f"{fn}/report_length", "8")
+        _write(f"{fn}/report_desc", REPORT_DESC)
+
+        os.makedirs(f"{r}/configs/c.1")
+        _write(f"{r}/configs/c.1/MaxPower", "100")
+        # Remote wakeup, as most pads advertise: usbhid may then autosuspend
+        # the pad even while it is open
+        _write(f"{r}/configs/c.1/bmAttributes", "0xa0")
+        os.symlink(fn, f"{r}/configs/c.1/hid.usb0")
+
+        udcs = sorted(u for u in os.listdir("/sys/class/udc") if u.startswith("dummy_udc"))
+        if not udcs:
+            raise RuntimeError("no dummy_udc (kernel needs CONFIG_USB_DUMMY_HCD)")
+        _write(f"{r}/UDC", udcs[0])
+
+        self.fd = os.open(self._hidg_node(fn), os.O_RDWR | os.O_NONBLOCK)
+        return self
+
+    def _hidg_node(self, fn):
+        with open(f"{fn}/dev") as f:
+            major, minor = (int(x) for x in f.read().split(":"))
+        for path in glob.glob("/dev/hidg*"):
+            st = os.stat(path)
+            if os.major(st.st_rdev) == major and os.minor(st.st_rdev) == minor:
+                return path
+        raise RuntimeError("hidg device node not found")
+
+    def destroy(self):
+        if self.fd is not None:
+            os.close(self.fd)
+            self.fd = None
+        r = self.root
+        if not os.path.exists(r):
+            return
+        try:
+            _write(f"{r}/UDC", "\n")
+        except OSError:
+            pass
+        if os.path.islink(f"{r}/configs/c.1/hid.usb0"):
+            os.unlink(f"{r}/configs/c.1/hid.usb0")
+        for path in (f"{r}/configs/c.1", f"{r}/functions/hid.usb0", f"{r}/strings/0x409", r):
+            try:
+                os.rmdir(path)
+            except OSError:
+                pass
+
+    def send(self, x=0x7F, y=0x7F, buttons=0, timeout=1.0):
+        # The host must poll the interrupt endpoint before the next report
+        # fits; False if it did not within TIMEOUT
+        report = bytes([x, y, 0x7F, 0x7F, buttons, 0, 0, 0])
+        _, w, _ = select.select([], [self.fd], [], timeout)
+        if not w:
+            return False
+        try:
+            os.write(self.fd, report)
+        except BlockingIOError:
+            return False
+        return True
+
+    def press(self, action, timeout=1.0):
+        action = action.lower()
+        if action in AXES:
+            x, y = AXES[action]
+            return self.send(x, y, 0, timeout)
+        if action in BUTTONS:
+            return self.send(buttons=BUTTONS[action], timeout=timeout)
+        raise ValueError(f"unknown pad action '{action}'")
+
+    def release(self, timeout=1.0):
+        return self.send(timeout=timeout)
+
+    def usb_sysfs(self, timeout=5.0):
+        # /sys/bus/usb/devices/N-M of the gadget as the host sees it
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for dev in glob.glob("/sys/bus/usb/devices/*"):
+                try:
+                    with open(f"{dev}/product") as f:
+                        if f.read().strip() == PRODUCT:
+                            return dev
+                except OSError:
+                    continue
+            time.sleep(0.05)
+        return None
+
+    def event_device(self, timeout=5.0):
+        # /dev/input/eventX created by usbhid for the gadget on the host
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for ev in glob.glob("/sys/class/input/event*"):
+                try:
+                    with open(f"{ev}/device/name") as f:
+                        if PRODUCT in f.read():
+                            return "/dev/input/" + os.path.basename(ev)
+                except OSError:
+                    continue
+            time.sleep(0.05)
+        return None
+
+
+def main():
+    with VirtualPad() as pad:
+        print(f"{PRODUCT} up ({pad.vid:04x}:{pad.pid:04x}); "
+              f"actions: {', '.join(list(AXES) + list(BUTTONS))}, quit")
+        for line in sys.stdin:
+            action = line.strip().lower()
+            if action in ("quit", "exit"):
+                break
+            if not action:
+                continue
+            try:
+                ok = pad.press(action)
+                time.sleep(0.1)
+                pad.release()
+                print("ok" if ok else "not polled (is the pad attached to a host?)")
+            except ValueError as e:
+                print(e)
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)
@@ -60,6 +60,7 @@ step "0/5" "Limpiando versiones anteriores..."
 systemctl disable boot-selector.service 2>/dev/null || true
 rm -f /etc/systemd/system/boot-selector.service
 rm -rf /etc/systemd/system/display-manager.service.d/wait-boot-selector.conf
+rm -f /etc/systemd/system/boot-selector.slice
 rm -f /run/boot-selector-done
 
 OLD_DM=$(cat /opt/boot-selector/.dm-service 2>/dev/null || true)
@@ -146,70 +147,6 @@ mkdir -p /opt/boot-selector
 
 echo "$DM_SERVICE" > /opt/boot-selector/.dm-service
 
-cat > /opt/boot-selector/run.sh << 'RUNEOF'
-#!/bin/bash
-set +e
-
-LOGFILE="/var/log/boot-selector.log"
-FLAG="/run/boot-selector-done"
-
-log() { echo "$(date '+%Y-%m-%d %H:%M:%S') RUN: $*" >> "$LOGFILE"; }
-
-log "========================================"
-log "run.sh started (PID=$$)"
-
-if [ -f "$FLAG" ]; then
-    log "Flag exists -> skip"
-    exit 0
-fi
-
-# Esperar USB
-log "Waiting 2s for USB..."
-sleep 2
-
-# Detener Plymouth si existe
-if command -v plymouth &>/dev/null; then
-    log "Stopping Plymouth..."
-    plymouth quit 2>/dev/null && log "Plymouth quit OK" || log "Plymouth quit failed"
-    sleep 0.5
-else
-    log "Plymouth not found (skipping)"
-fi
-
-# Forzar modo texto en tty1
-log "Forcing tty1 to text mode (KD_TEXT)..."
-/usr/bin/python3 -c "
-import fcntl, os
-fd = os.open('/dev/tty1', os.O_WRONLY)
-try:
-    fcntl.ioctl(fd, 0x4B3A, 0)
-finally:
-    os.close(fd)
-" 2>/dev/null && log "tty1 KD_TEXT OK" || log "tty1 KD_TEXT failed"
-
-# Cambiar a tty1
-log "Switching to tty1..."
-chvt 1 2>/dev/null && log "chvt 1 OK" || log "chvt 1 failed"
-sleep 0.3
-
-# Limpiar pantalla
-printf '\033[2J\033[H' > /dev/tty1 2>/dev/null
-
-# Ejecutar selector
-log "Starting selector.py on tty1..."
-/usr/bin/python3 /opt/boot-selector/selector.py < /dev/tty1 > /dev/tty1 2>> "$LOGFILE"
-RESULT=$?
-log "selector.py exited with code $RESULT"
-
-# Marcar como ejecutado
-: > "$FLAG"
-log "Flag created"
-
-log "run.sh finished"
-exit 0
-RUNEOF
-chmod +x /opt/boot-selector/run.sh
-
 cat > /opt/boot-selector/selector.py << 'PYEOF'
 #!/usr/bin/env python3
 """
@@ -225,6 +162,14 @@ import logging
 import subprocess
 import re
 import shutil
+import glob
+import ctypes
+import threading
+import queue
+import fcntl
+import socket
+import termios
+import tty
 
 # --- Logging ---
 
@@ -236,6 +181,44 @@ logging.basicConfig(
 log = logging.getLogger("boot-selector")
 log.info("selector.py started (PID=%d)", os.getpid())
 
+T0 = time.monotonic()
+
+# BOOT_SELECTOR_TRACE=/path: also append "<CLOCK_MONOTONIC ms> <event>" lines,
+# comparable with other processes (bench, systemd-analyze)
+TRACE_PATH = os.environ.get("BOOT_SELECTOR_TRACE")
+try:
+    TRACE_FILE = open(TRACE_PATH, "a", buffering=1) if TRACE_PATH else None
+except OSError:
+    TRACE_FILE = None
+
+# boot_selector.markers=ttyS0 on the kernel command line: also write each
+# event as "BSEL:<EVENT>" to that console, for bench/e2e_qemu.py
+def _marker_fd():
+    try:
+        with open("/proc/cmdline") as f:
+            for arg in f.read().split():
+                if arg.startswith("boot_selector.markers="):
+                    dev = "/dev/" + os.path.basename(arg.split("=", 1)[1])
+                    return os.open(dev, os.O_WRONLY | os.O_NOCTTY | os.O_NONBLOCK)
+    except OSError:
+        pass
+    return None
+
+MARKER_FD = _marker_fd()
+
+def trace(event, quiet=False):
+    # Timing trace: milliseconds since selector start
+    now = time.monotonic()
+    if not quiet:
+        log.info("TRACE %s +%.1fms", event, (now - T0) * 1000)
+    if TRACE_FILE:
+        TRACE_FILE.write(f"{now * 1000:.3f} {event}\n")
+    if MARKER_FD is not None:
+        try:
+            os.write(MARKER_FD, f"BSEL:{event.upper().replace(' ', '_')}\r\n".encode())
+        except OSError:
+            pass
+
 # --- Config ---
 
 TIMEOUT = 15
@@ -245,6 +228,37 @@ APP_VERSION = "2026.02.04"
 COMPANY_SITE = "nuevauno.com"
 COMPANY_EMAIL = "hola@nuevauno.com"
 
+# --boot: lanzado por el display manager (antes via run.sh)
+BOOT_MODE = "--boot" in sys.argv
+FLAG = "/run/boot-selector-done"
+BOOT_TTY = "/dev/tty1"
+USB_WAIT = 2.0
+
+# --gamepad PATH: use this device, same as /opt/boot-selector/gamepad-path
+GAMEPAD_ARG = sys.argv[sys.argv.index("--gamepad") + 1] if "--gamepad" in sys.argv[:-1] else None
+# --usb-poll-ms N: same as /opt/boot-selector/usb-poll-ms; --no-usb-tuning
+# leaves the pad's USB settings alone (bench baseline)
+USB_POLL_ARG = sys.argv[sys.argv.index("--usb-poll-ms") + 1] if "--usb-poll-ms" in sys.argv[:-1] else None
+USB_TUNING = "--no-usb-tuning" not in sys.argv
+
+if BOOT_MODE and os.path.exists(FLAG):
+    log.info("Flag exists -> skip")
+    sys.exit(0)
+
+GRUB_DIR = "/boot/grub"
+GRUB_CFG = os.path.join(GRUB_DIR, "grub.cfg")
+GRUBENV = os.path.join(GRUB_DIR, "grubenv")
+GRUBENV_SIZE = 1024
+
+# "systemctl" (default): systemctl reboot --no-block
+# "syscall": sync + reboot(2) directly, skips the orderly shutdown
+REBOOT_MODE_FILE = "/opt/boot-selector/reboot-mode"
+try:
+    with open(REBOOT_MODE_FILE) as f:
+        REBOOT_MODE = f.read().strip() or "systemctl"
+except OSError:
+    REBOOT_MODE = "systemctl"
+
 # --- evdev ---
 
 try:
@@ -254,6 +268,7 @@ try:
     log.info("evdev OK")
 except ImportError:
     HAS_EVDEV = False
+    ecodes = None
     log.warning("evdev not available")
 
 # --- Colors ---
@@ -344,58 +359,126 @@ SELECT_BUTTONS = {
 SELECT_BUTTONS = {c for c in SELECT_BUTTONS if c is not None}
 
 BTN_EXCLUDE = {
-    "BTN_LEFT", "BTN_RIGHT", "BTN_MIDDLE", "BTN_SIDE", "BTN_EXTRA",
+    "BTN_MOUSE", "BTN_LEFT", "BTN_RIGHT", "BTN_MIDDLE", "BTN_SIDE", "BTN_EXTRA",
     "BTN_FORWARD", "BTN_BACK", "BTN_TASK", "BTN_TOUCH", "BTN_TOOL_PEN",
     "BTN_TOOL_FINGER", "BTN_TOOL_RUBBER", "BTN_TOOL_BRUSH", "BTN_TOOL_PENCIL",
     "BTN_TOOL_MOUSE", "BTN_STYLUS", "BTN_STYLUS2",
 }
 
-def _iter_key_names(code):
-    try:
-        name = ecodes.bytype[ecodes.EV_KEY].get(code, "")
-    except Exception:
-        return []
-    if isinstance(name, (list, tuple)):
-        return [n for n in name if isinstance(n, str)]
-    if isinstance(name, str) and name:
-        return [name]
-    return []
-
-def find_gamepad():
+# --- Capability bitmaps ---
+#
+# Devices are scored from the raw EVIOCGBIT bitmaps (Python ints, bit N =
+# code N) ANDed with masks computed once here, so a keyboard with hundreds
+# of keys costs the same as a pad.
+
+EV_SYN, EV_KEY, EV_REL, EV_ABS = 0x00, 0x01, 0x02, 0x03
+KEY_MAX = 0x2ff
+ABS_MAX = 0x3f
+
+def EVIOCGBIT(ev, size):
+    # _IOR('E', 0x20 + ev, size)
+    return (2 << 30) | (size << 16) | (ord('E') << 8) | (0x20 + ev)
+
+def capbits(fd, ev, maxcode):
+    buf = bytearray(maxcode // 8 + 1)
+    fcntl.ioctl(fd, EVIOCGBIT(ev, len(buf)), buf, True)
+    return int.from_bytes(buf, "little")
+
+def popcount(x):
+    return bin(x).count("1")
+
+def _mask(codes):
+    m = 0
+    for c in codes:
+        if c is not None:
+            m |= 1 << c
+    return m
+
+def _btn_mask():
+    # Every BTN_* code that is not mouse/tablet
+    m = 0
+    if not HAS_EVDEV:
+        return m
+    for code, names in ecodes.bytype[ecodes.EV_KEY].items():
+        names = names if isinstance(names, (list, tuple)) else [names]
+        if any(n.startswith("BTN_") for n in names) and not any(n in BTN_EXCLUDE for n in names):
+            m |= 1 << code
+    return m
+
+ABS_GAMEPAD_MASK = _mask(ABS_GAMEPAD_AXES)
+GAMEPAD_KEY_MASK = _mask(GAMEPAD_BUTTONS)
+DPAD_MASK = _mask((DPAD_UP, DPAD_DOWN))
+BTN_MASK = _btn_mask()
+KEYBOARD_MASK = _mask(range(1, 84))            # KEY_ESC .. KEY_KPDOT
+MOUSE_MASK = _mask(range(0x110, 0x118))        # BTN_LEFT .. BTN_TASK
+KEYBOARD_MIN_KEYS = 20
+
+# key code -> action, built once; read_gamepad does a dict lookup per event
+KEY_ACTIONS = {code: 'select' for code in range(KEY_MAX + 1) if BTN_MASK >> code & 1}
+KEY_ACTIONS.update({c: 'select' for c in SELECT_BUTTONS})
+if DPAD_UP is not None:
+    KEY_ACTIONS[DPAD_UP] = 'up'
+if DPAD_DOWN is not None:
+    KEY_ACTIONS[DPAD_DOWN] = 'down'
+
+ABS_ACTIONS = {
+    getattr(ecodes, "ABS_Y", None): 'axis',
+    getattr(ecodes, "ABS_RY", None): 'axis',
+    getattr(ecodes, "ABS_HAT0Y", None): 'hat',
+}
+ABS_ACTIONS.pop(None, None)
+AXIS_DEFAULT = (64, 190)                       # 0..255 axis, center +/- 1/4
+
+def axis_thresholds(dev, abs_bits):
+    # code -> (low, high) trip points, computed once per device
+    axis_info = {}
+    for code in ABS_ACTIONS:
+        if not abs_bits >> code & 1:
+            continue
+        try:
+            info = dev.absinfo(code)
+            lo, hi = info.min, info.max
+        except Exception:
+            lo, hi = 0, 255
+        center = (lo + hi) // 2
+        thresh = (hi - lo) // 4
+        axis_info[code] = (center - thresh, center + thresh)
+    return axis_info
+
+def find_gamepad(pref=None):
     if not HAS_EVDEV:
         return None
     # 1) Prefer explicit override if present
     try:
-        if os.path.exists(PREFERRED_DEVICE_FILE):
+        pref = pref or GAMEPAD_ARG
+        if not pref and os.path.exists(PREFERRED_DEVICE_FILE):
             with open(PREFERRED_DEVICE_FILE, "r") as f:
                 pref = f.read().strip()
-            if pref:
-                pref = os.path.realpath(pref)
-                if os.path.exists(pref):
-                    dev = evdev.InputDevice(pref)
-                    caps = dev.capabilities(verbose=False)
-                    axis_info = {}
-                    if ecodes.EV_ABS in caps:
-                        for code, info in caps[ecodes.EV_ABS]:
-                            if code in ABS_GAMEPAD_AXES:
-                                axis_info[code] = {'min': info.min, 'max': info.max}
-                    log.info("Using preferred gamepad: %s (%s)", dev.name, dev.path)
-                    return dev, axis_info
+        if pref:
+            pref = os.path.realpath(pref)
+            if os.path.exists(pref):
+                dev = evdev.InputDevice(pref)
+                axis_info = axis_thresholds(dev, capbits(dev.fd, EV_ABS, ABS_MAX))
+                log.info("Using preferred gamepad: %s (%s)", dev.name, dev.path)
+                return dev, axis_info
     except Exception as e:
         log.warning("Preferred device failed: %s", e)
 
     best = None
     best_score = None
     for path in evdev.list_devices():
+        dev = None
         try:
             dev = evdev.InputDevice(path)
-            caps = dev.capabilities(verbose=False)
+            ev_bits = capbits(dev.fd, EV_SYN, 0x1f)
+            key_bits = capbits(dev.fd, EV_KEY, KEY_MAX) if ev_bits >> EV_KEY & 1 else 0
+            abs_bits = capbits(dev.fd, EV_ABS, ABS_MAX) if ev_bits >> EV_ABS & 1 else 0
             score = 0
             props = _uevent_props(path)
             is_gamepad = props.get("ID_INPUT_GAMEPAD") == "1"
             is_joystick = props.get("ID_INPUT_JOYSTICK") == "1"
-            is_keyboard = props.get("ID_INPUT_KEYBOARD") == "1"
-            is_mouse = props.get("ID_INPUT_MOUSE") == "1"
+            is_keyboard = props.get("ID_INPUT_KEYBOARD") == "1" or popcount(key_bits & KEYBOARD_MASK) >= KEYBOARD_MIN_KEYS
+            is_mouse = props.get("ID_INPUT_MOUSE") == "1" or bool(ev_bits >> EV_REL & 1 and key_bits & MOUSE_MASK)
             if is_gamepad:
                 score += 20
             if is_joystick:
@@ -408,53 +491,45 @@ def find_gamepad():
             if is_keyboard or is_mouse:
                 score -= 5
 
-            abs_codes = []
-            if ecodes.EV_ABS in caps:
-                abs_codes = [c for c, _ in caps[ecodes.EV_ABS]]
-                if any(c in ABS_GAMEPAD_AXES for c in abs_codes):
-                    score += 3
-
-            key_codes = []
-            key_names = []
-            if ecodes.EV_KEY in caps:
-                key_codes = [c for c in caps[ecodes.EV_KEY]]
-                if any(c in GAMEPAD_BUTTONS for c in key_codes):
-                    score += 5
-                if DPAD_UP in key_codes or DPAD_DOWN in key_codes:
-                    score += 2
-                for c in key_codes:
-                    key_names.extend(_iter_key_names(c))
-                if any(n.startswith("BTN_") and n not in BTN_EXCLUDE for n in key_names):
-                    score += 3
-
-            axis_info = {}
-            if abs_codes:
-                for code, info in caps[ecodes.EV_ABS]:
-                    if code in ABS_GAMEPAD_AXES:
-                        axis_info[code] = {'min': info.min, 'max': info.max}
+            abs_count = popcount(abs_bits & ABS_GAMEPAD_MASK)
+            btn_count = popcount(key_bits & BTN_MASK)
+            if abs_count:
+                score += 3
+            if key_bits & GAMEPAD_KEY_MASK:
+                score += 5
+            if key_bits & DPAD_MASK:
+                score += 2
+            if btn_count:
+                score += 3
 
             # Skip obvious keyboard/mouse unless it is explicitly marked as gamepad/joystick
             if (is_keyboard or is_mouse) and not (is_gamepad or is_joystick):
                 log.info("Skip (keyboard/mouse): %s (%s) props=%s", dev.name, dev.path, props)
+                dev.close()
                 continue
 
             # Avoid mouse-only devices
-            if ecodes.EV_REL in caps and not (is_gamepad or is_joystick):
+            if ev_bits >> EV_REL & 1 and not (is_gamepad or is_joystick):
                 score -= 5
 
             if score > 0:
-                log.info("Candidate: %s (%s) score=%d abs=%s props=%s", dev.name, dev.path, score, abs_codes, props)
+                log.info("Candidate: %s (%s) score=%d abs=%#x props=%s", dev.name, dev.path, score, abs_bits, props)
                 # Tie-breakers
-                abs_count = len([c for c in abs_codes if c in ABS_GAMEPAD_AXES])
-                btn_count = len([n for n in key_names if n.startswith("BTN_") and n not in BTN_EXCLUDE])
                 tie = (score, int(is_gamepad), int(is_joystick), abs_count, btn_count)
                 if best is None or best_score is None or tie > best_score:
-                    best = (dev, axis_info)
+                    if best:
+                        best[0].close()
+                    best = (dev, abs_bits)
                     best_score = tie
+                    continue
+            dev.close()
         except (PermissionError, OSError) as e:
             log.debug("Skip %s: %s", path, e)
+            if dev:
+                dev.close()
     if best:
-        dev, axis_info = best
+        dev, abs_bits = best
+        axis_info = axis_thresholds(dev, abs_bits)
         log.info("Gamepad selected: %s (%s) score=%s axes=%s", dev.name, dev.path, best_score, axis_info)
         return dev, axis_info
     log.warning("No gamepad found")
@@ -469,76 +544,635 @@ def read_gamepad(dev, axis_info, timeout=0.05):
             return None
         last = None
         for event in dev.read():
-            if event.type == ecodes.EV_ABS:
-                if event.code in (getattr(ecodes, "ABS_Y", -1), getattr(ecodes, "ABS_RY", -2)):
-                    info = axis_info.get(event.code, {'min': 0, 'max': 255})
-                    center = (info['min'] + info['max']) // 2
-                    thresh = (info['max'] - info['min']) // 4
-                    if event.value < center - thresh:
+            if event.type == EV_KEY:
+                if event.value == 1:
+                    last = KEY_ACTIONS.get(event.code, last)
+            elif event.type == EV_ABS:
+                kind = ABS_ACTIONS.get(event.code)
+                if kind == 'axis':
+                    lo, hi = axis_info.get(event.code, AXIS_DEFAULT)
+                    if event.value < lo:
                         last = 'up'
-                    elif event.value > center + thresh:
+                    elif event.value > hi:
                         last = 'down'
-                elif event.code == getattr(ecodes, "ABS_HAT0Y", -1):
+                elif kind == 'hat':
                     if event.value < 0:
                         last = 'up'
                     elif event.value > 0:
                         last = 'down'
-            elif event.type == ecodes.EV_KEY and event.value == 1:
-                if event.code == DPAD_UP:
-                    last = 'up'
-                elif event.code == DPAD_DOWN:
-                    last = 'down'
-                elif event.code in SELECT_BUTTONS:
-                    last = 'select'
-                else:
-                    # Fallback: cualquier BTN_* que no sea mouse/teclado -> seleccionar
-                    names = _iter_key_names(event.code)
-                    if any(n.startswith("BTN_") and n not in BTN_EXCLUDE and n not in ("BTN_DPAD_UP", "BTN_DPAD_DOWN") for n in names):
-                        last = 'select'
         return last
     except (OSError, IOError) as e:
         log.error("Gamepad error: %s", e)
     return None
 
+# --- USB tuning ---
+#
+# Runtime autosuspend and usbhid's default polling interval can add tens of
+# ms to the first press, the one that matters here. While the menu is up the
+# pad's USB device and the hubs above it are pinned to power/control=on and,
+# if /opt/boot-selector/usb-poll-ms is set, usbhid polls it at that interval
+# (jspoll, applied by rebinding the interface). usbhid only uses jspoll when
+# the top-level collection is Generic Desktop / Joystick; Game Pad usage
+# keeps the endpoint's bInterval, so those pads are not rebound at all.
+# Restored on exit.
+
+USB_POLL_FILE = "/opt/boot-selector/usb-poll-ms"
+USBHID_JSPOLL = "/sys/module/usbhid/parameters/jspoll"
+USBHID_DRIVER = "/sys/bus/usb/drivers/usbhid"
+HID_GD_JOYSTICK = 0x00010004
+
+def _sysfs_read(path):
+    with open(path) as f:
+        return f.read().strip()
+
+def _sysfs_write(path, value):
+    with open(path, "w") as f:
+        f.write(value)
+
+def usb_poll_ms():
+    val = USB_POLL_ARG
+    if val is None:
+        try:
+            val = _sysfs_read(USB_POLL_FILE)
+        except OSError:
+            return None
+    try:
+        ms = int(val)
+    except ValueError:
+        log.warning("Bad usb-poll-ms '%s'", val)
+        return None
+    return ms if 1 <= ms <= 255 else None
+
+def _usbhid_rebind(intf):
+    try:
+        _sysfs_write(os.path.join(USBHID_DRIVER, "unbind"), intf)
+    except OSError:
+        pass    # not bound: an earlier rebind failed half way
+    _sysfs_write(os.path.join(USBHID_DRIVER, "bind"), intf)
+
+def hid_collection_usage(intf):
+    """
+    Usage (page << 16 | id) of the first collection in the HID report
+    descriptor of USB interface INTF, as usbhid_start() checks it. None if
+    unknown.
+    """
+    paths = glob.glob(os.path.join(intf, "*:*:*.*", "report_descriptor"))
+    if not paths:
+        return None
+    try:
+        with open(paths[0], "rb") as f:
+            desc = f.read()
+    except OSError:
+        return None
+    page = usage = 0
+    i = 0
+    while i < len(desc):
+        b = desc[i]
+        if b == 0xFE:                   # long item
+            i += 3 + (desc[i + 1] if i + 1 < len(desc) else 0)
+            continue
+        size = (0, 1, 2, 4)[b & 0x03]
+        val = int.from_bytes(desc[i + 1:i + 1 + size], "little")
+        tag = b & 0xFC
+        if tag == 0x04:                 # Usage Page
+            page = val
+        elif tag == 0x08:               # Usage
+            usage = val if size == 4 else (page << 16) | val
+        elif tag == 0xA0:               # Collection
+            return usage
+        i += 1 + size
+    return None
+
+class UsbTuning:
+    def __init__(self):
+        self.power = []       # (power/control path, original value)
+        self.jspoll = None    # original usbhid jspoll
+        self.intf = None      # interface rebound with the new interval
+
+    def apply(self, devpath):
+        """
+        Ajusta el dispositivo USB del gamepad. Devuelve el nodo evdev a usar:
+        el mismo, uno nuevo si usbhid se re-enlazo, o None si se perdio.
+        """
+        d = os.path.realpath(f"/sys/class/input/{os.path.basename(devpath)}/device")
+        intf = None
+        while d.startswith("/sys/devices/"):
+            if intf is None and os.path.exists(os.path.join(d, "bInterfaceNumber")):
+                intf = d
+            if os.path.exists(os.path.join(d, "idVendor")):
+                self._power_on(os.path.join(d, "power", "control"))
+            d = os.path.dirname(d)
+        if intf is None:
+            log.info("Gamepad is not on USB, no tuning")
+            return devpath
+        trace("usb power on")
+
+        ms = usb_poll_ms()
+        if ms is None:
+            return devpath
+        usage = hid_collection_usage(intf)
+        if usage != HID_GD_JOYSTICK:
+            log.info("usbhid jspoll ignored for usage %s, not rebinding",
+                     "unknown" if usage is None else f"{usage:08x}")
+            return devpath
+        try:
+            old = _sysfs_read(USBHID_JSPOLL)
+        except OSError:
+            log.info("usbhid jspoll not available")
+            return devpath
+        if old == str(ms):
+            return devpath
+        try:
+            _sysfs_write(USBHID_JSPOLL, str(ms))
+        except OSError as e:
+            log.warning("usbhid jspoll %d ms failed: %s", ms, e)
+            return devpath
+        self.jspoll = old
+        # Recorded before unbinding: restore() must bind it again even if
+        # the rebind below fails half way
+        self.intf = os.path.basename(intf)
+        try:
+            _usbhid_rebind(self.intf)
+        except OSError as e:
+            # The old node may be gone with the unbind: let the caller rescan
+            log.warning("usbhid rebind of %s failed: %s", self.intf, e)
+            return None
+        log.info("usbhid jspoll %s -> %d ms (%s rebound)", old, ms, self.intf)
+        trace("usb poll set")
+        return self._event_node(intf)
+
+    def _power_on(self, path):
+        try:
+            old = _sysfs_read(path)
+            if old != "on":
+                _sysfs_write(path, "on")
+                self.power.append((path, old))
+                log.info("%s: %s -> on", path, old)
+        except OSError as e:
+            log.warning("%s: %s", path, e)
+
+    def _event_node(self, intf, timeout=1.0):
+        # The rebind creates a new input device under the same interface
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for name in os.listdir("/sys/class/input"):
+                if name.startswith("event") and \
+                        os.path.realpath(f"/sys/class/input/{name}").startswith(intf + "/"):
+                    return f"/dev/input/{name}"
+            time.sleep(0.01)
+        return None
+
+    def restore(self):
+        if self.jspoll is not None:
+            try:
+                _sysfs_write(USBHID_JSPOLL, self.jspoll)
+            except OSError as e:
+                log.warning("usbhid jspoll restore failed: %s", e)
+            if self.intf:
+                try:
+                    _usbhid_rebind(self.intf)
+                except OSError as e:
+                    log.warning("usbhid rebind of %s failed: %s", self.intf, e)
+            self.jspoll = self.intf = None
+        for path, old in reversed(self.power):
+            try:
+                _sysfs_write(path, old)
+            except OSError as e:
+                log.warning("%s restore failed: %s", path, e)
+        if self.power:
+            trace("usb restored")
+        self.power = []
+
 # --- Keyboard ---
 
 def setup_keyboard():
-    import termios, tty
     fd = sys.stdin.fileno()
     old = termios.tcgetattr(fd)
     tty.setcbreak(fd)
     return old
 
 def restore_keyboard(old):
-    import termios
     try:
         termios.tcsetattr(sys.stdin.fileno(), termios.TCSADRAIN, old)
     except Exception:
         pass
 
-def read_keyboard(timeout=0.05):
-    try:
-        r, _, _ = select.select([sys.stdin], [], [], timeout)
-        if not r:
+# CSI/SS3 final byte (or "N~" for VT-style keys) -> action
+KEY_SEQUENCES = {
+    "A": 'up', "B": 'down',       # arrows
+    "H": 'up', "F": 'down',       # Home / End (xterm)
+    "1~": 'up', "4~": 'down',     # Home / End (linux console)
+    "7~": 'up', "8~": 'down',     # Home / End (rxvt)
+    "5~": 'up', "6~": 'down',     # PgUp / PgDn
+}
+
+class KeyParser:
+    """
+    Parser incremental de secuencias de escape (ESC, CSI, SS3).
+    Recibe bytes tal como llegan del tty; nunca espera bytes faltantes.
+    """
+
+    GROUND, ESC, CSI, SS3 = range(4)
+
+    def __init__(self):
+        self.state = self.GROUND
+        self.params = ""
+        self.idle_polls = 0
+
+    def feed(self, data):
+        self.idle_polls = 0
+        actions = []
+        for b in data:
+            action = self._step(b)
+            if action:
+                actions.append(action)
+        return actions
+
+    def _step(self, b):
+        ch = chr(b)
+        if self.state == self.GROUND:
+            if b == 0x1b:
+                self.state = self.ESC
+            elif ch in ('\r', '\n'):
+                return 'select'
             return None
-        key = sys.stdin.read(1)
-        if key == '\x1b':
-            r2, _, _ = select.select([sys.stdin], [], [], 0.05)
-            if r2:
-                seq = sys.stdin.read(2)
-                if seq == '[A': return 'up'
-                if seq == '[B': return 'down'
-        elif key in ('\r', '\n'):
-            return 'select'
-    except Exception:
-        pass
+        if self.state == self.ESC:
+            if ch == '[':
+                self.state, self.params = self.CSI, ""
+                return None
+            if ch == 'O':
+                self.state = self.SS3
+                return None
+            # Lone ESC followed by a normal key
+            self.state = self.GROUND
+            return self._step(b)
+        if self.state == self.SS3:
+            self.state = self.GROUND
+            return KEY_SEQUENCES.get(ch)
+        # CSI: parameter/intermediate bytes until a final byte
+        if 0x20 <= b <= 0x3f:
+            self.params += ch
+            return None
+        self.state = self.GROUND
+        if not 0x40 <= b <= 0x7e:
+            return None
+        if ch == '~':
+            return KEY_SEQUENCES.get(self.params.split(";")[0] + "~")
+        return KEY_SEQUENCES.get(ch)
+
+    def idle(self):
+        # No more bytes pending. The first idle poll comes right after the
+        # read that ended in ESC, so keep it for one more loop iteration
+        # (up to one select timeout) before taking it as a plain Escape
+        if self.state != self.ESC:
+            return
+        self.idle_polls += 1
+        if self.idle_polls > 1:
+            self.state = self.GROUND
+
+class KeyboardReader:
+    def __init__(self, fd):
+        self.fd = fd
+        self.parser = KeyParser()
+        self.pending = []
+
+    def read(self):
+        # Drain everything available without blocking, return one action
+        while self.fd is not None and not self.pending:
+            try:
+                r, _, _ = select.select([self.fd], [], [], 0)
+                if not r:
+                    self.parser.idle()
+                    break
+                data = os.read(self.fd, 256)
+            except (OSError, ValueError) as e:
+                log.warning("Keyboard read failed: %s", e)
+                data = b""
+            if not data:
+                log.info("Keyboard closed (EOF)")
+                self.fd = None
+                break
+            self.pending.extend(self.parser.feed(data))
+        return self.pending.pop(0) if self.pending else None
+
+# --- Headless ---
+
+DRM_SYSFS = "/sys/class/drm"
+BUS_I8042 = 0x11
+
+def display_connected():
+    # Any DRM connector (cardN-HDMI-A-1, ...) with status "connected".
+    # No DRM connectors at all: only trust a framebuffer as a display.
+    found = False
+    try:
+        names = os.listdir(DRM_SYSFS)
+    except OSError:
+        names = []
+    for n in names:
+        if "-" not in n:
+            continue
+        found = True
+        try:
+            with open(os.path.join(DRM_SYSFS, n, "status")) as f:
+                if f.read().strip() == "connected":
+                    return True
+        except OSError:
+            continue
+    return not found and os.path.exists("/sys/class/graphics/fb0")
+
+def keyboard_present():
+    # i8042 is ignored: firmware and VMs expose an AT keyboard even when
+    # nothing is plugged in.
+    if not HAS_EVDEV:
+        return True
+    for path in evdev.list_devices():
+        base = os.path.basename(path)
+        try:
+            with open(f"/sys/class/input/{base}/device/id/bustype") as f:
+                if int(f.read(), 16) == BUS_I8042:
+                    continue
+            fd = os.open(path, os.O_RDONLY | os.O_NONBLOCK)
+            try:
+                keys = capbits(fd, EV_KEY, KEY_MAX)
+            finally:
+                os.close(fd)
+        except (OSError, ValueError):
+            continue
+        if popcount(keys & KEYBOARD_MASK) >= KEYBOARD_MIN_KEYS:
+            log.info("Keyboard present: %s", path)
+            return True
+    return False
+
+# --- Isolation ---
+#
+# Boot is when the machine is busiest: the display manager and dozens of
+# units start next to us and I/O is saturated. The drop-in already puts us
+# in boot-selector.slice (high CPU/IO weight); on top of that the process
+# raises its own priority and locks its pages so a redraw never waits on a
+# page-in. Everything the menu needs is imported/read before it appears.
+
+try:
+    _libc = ctypes.CDLL(None, use_errno=True)
+except OSError:
+    _libc = None
+
+MCL_CURRENT, MCL_FUTURE = 1, 2
+SELECTOR_NICE = -10
+IOPRIO_CLASS_RT = 1
+IOPRIO_CLASS_SHIFT = 13
+IOPRIO_WHO_PROCESS = 1
+IOPRIO_LEVEL = 4
+SYS_IOPRIO_SET = {
+    "x86_64": 251, "i686": 289, "i386": 289,
+    "aarch64": 30, "riscv64": 30, "armv7l": 314, "armv6l": 314,
+}
+
+def isolate():
+    try:
+        os.setpriority(os.PRIO_PROCESS, 0, SELECTOR_NICE)
+    except OSError as e:
+        log.warning("setpriority failed: %s", e)
+    if _libc is None:
+        return
+    nr = SYS_IOPRIO_SET.get(os.uname().machine)
+    if nr is not None:
+        prio = (IOPRIO_CLASS_RT << IOPRIO_CLASS_SHIFT) | IOPRIO_LEVEL
+        if _libc.syscall(nr, IOPRIO_WHO_PROCESS, 0, prio) != 0:
+            log.warning("ioprio_set failed (errno=%d)", ctypes.get_errno())
+    if _libc.mlockall(MCL_CURRENT | MCL_FUTURE) != 0:
+        log.warning("mlockall failed (errno=%d)", ctypes.get_errno())
+    trace("isolated")
+
+# --- Boot prep ---
+
+KDSETMODE = 0x4B3A
+KD_TEXT = 0x00
+VT_ACTIVATE = 0x5606
+VT_WAITACTIVE = 0x5607
+
+PLYMOUTH_SOCKET = b"\0/org/freedesktop/plymouthd"
+PLYMOUTH_QUIT = b"Q\x02\x01\x00"   # quit, retain-splash=false
+PLYMOUTH_ACK = b"\x06"
+
+def plymouth_quit():
+    # Same request `plymouth quit` sends; the ACK arrives once plymouthd
+    # has released the display. None -> plymouthd not running.
+    for addr in (PLYMOUTH_SOCKET, PLYMOUTH_SOCKET.ljust(108, b"\0")):
+        try:
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+                s.settimeout(2.0)
+                s.connect(addr)
+                s.sendall(PLYMOUTH_QUIT)
+                return s.recv(1) == PLYMOUTH_ACK
+        except OSError:
+            continue
     return None
 
+def boot_prep():
+    """
+    Lo que antes hacia run.sh con chvt/plymouth/printf, en este proceso:
+    Plymouth fuera, tty1 en modo texto y activo, stdin/stdout en tty1.
+    """
+    r = plymouth_quit()
+    log.info("Plymouth quit %s", {True: "OK", False: "failed", None: "skipped (not running)"}[r])
+
+    fd = os.open(BOOT_TTY, os.O_RDWR | os.O_NOCTTY)
+    try:
+        fcntl.ioctl(fd, KDSETMODE, KD_TEXT)
+        log.info("tty1 KD_TEXT OK")
+    except OSError as e:
+        log.warning("tty1 KD_TEXT failed: %s", e)
+    try:
+        fcntl.ioctl(fd, VT_ACTIVATE, 1)
+        fcntl.ioctl(fd, VT_WAITACTIVE, 1)
+        log.info("VT 1 active")
+    except OSError as e:
+        log.warning("VT switch failed: %s", e)
+    os.dup2(fd, 0)
+    os.dup2(fd, 1)
+    os.close(fd)
+    sys.stdout = open(1, "w", buffering=1, encoding="utf-8", closefd=False)
+    sys.stdout.write('\033[2J\033[H')
+    sys.stdout.flush()
+    trace("boot prep done")
+
+# --- Windows prep ---
+
+def syncfs(path):
+    fd = os.open(path, os.O_RDONLY)
+    try:
+        if _libc is None or _libc.syncfs(fd) != 0:
+            os.sync()
+    finally:
+        os.close(fd)
+
+def read_grubenv():
+    try:
+        with open(GRUBENV, "rb") as f:
+            return f.read()
+    except FileNotFoundError:
+        return b"# GRUB Environment Block\n"
+
+def build_grubenv(entry, data):
+    # Same result as `grub-reboot <entry>`: grubenv DATA with next_entry
+    # set, padded with '#' to the fixed block size.
+    data = data[:data.rfind(b"\n") + 1]
+    lines = [l for l in data.splitlines(keepends=True) if not l.startswith(b"next_entry=")]
+    value = entry.replace("\\", "\\\\").replace("\n", "\\n")
+    lines.append(f"next_entry={value}\n".encode())
+    raw = b"".join(lines)
+    if len(raw) > GRUBENV_SIZE:
+        raise ValueError("grubenv overflow")
+    return raw + b"#" * (GRUBENV_SIZE - len(raw))
+
+class _PrepJob:
+    def __init__(self, path):
+        self.path = path
+        self.cancel = threading.Event()
+        self.done = threading.Event()
+        self.staged = False
+
+class WindowsPrep:
+    """
+    Prepara el reinicio a Windows mientras la opcion esta resaltada:
+    resuelve la entrada, deja el grubenv nuevo en un archivo temporal
+    y sincroniza /boot. Al confirmar solo queda rename + reboot.
+
+    grubenv se lee y el hilo se crea aca, al arrancar: con mlockall
+    (MCL_FUTURE) cada hilo nuevo fija y rellena su pila, y cada tecla
+    hacia Windows solo encola un trabajo.
+    """
+
+    STACK_SIZE = 256 * 1024
+
+    def __init__(self, entry=None):
+        self.entry = entry
+        self.job = None
+        self._seq = 0
+        self._grubenv = read_grubenv()
+        self._jobs = queue.SimpleQueue()
+        old = threading.stack_size(self.STACK_SIZE)
+        try:
+            threading.Thread(target=self._worker, daemon=True).start()
+        finally:
+            threading.stack_size(old)
+
+    def start(self):
+        if self.job and not self.job.cancel.is_set():
+            return
+        self._seq += 1
+        self.job = _PrepJob(f"{GRUBENV}.bsel-{os.getpid()}-{self._seq}")
+        self._jobs.put(self.job)
+        trace("prep start")
+
+    def _worker(self):
+        while True:
+            self._run(self._jobs.get())
+
+    def _run(self, job):
+        try:
+            if self.entry is None:
+                self.entry = get_windows_entry()
+            if self.entry is None or job.cancel.is_set() or TEST_MODE:
+                return
+            self._write(job.path, build_grubenv(self.entry, self._grubenv))
+            syncfs(GRUB_DIR)
+            job.staged = True
+            if job.cancel.is_set():
+                self._discard(job)
+            else:
+                trace("prep staged")
+        except Exception as e:
+            log.warning("Windows prep failed: %s", e)
+            self._discard(job)
+        finally:
+            job.done.set()
+
+    @staticmethod
+    def _write(path, data):
+        fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.write(fd, data)
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+
+    def _discard(self, job):
+        job.staged = False
+        try:
+            os.unlink(job.path)
+        except OSError:
+            pass
+
+    def cancel(self):
+        job, self.job = self.job, None
+        if job:
+            job.cancel.set()
+            if job.staged:
+                self._discard(job)
+            trace("prep cancel")
+
+    def commit(self, timeout=2.0):
+        # Atomically install the staged grubenv; False -> caller falls back
+        job = self.job
+        if not job or not job.done.wait(timeout) or not job.staged:
+            return False
+        try:
+            # grubenv may have changed since startup (grub-common clearing
+            # recordfail, ...): renaming the stale copy over it would undo
+            # that, so rebuild the staged block from the current file
+            current = read_grubenv()
+            if current != self._grubenv:
+                log.info("grubenv changed since startup, restaging")
+                self._write(job.path, build_grubenv(self.entry, current))
+                self._grubenv = current
+            os.rename(job.path, GRUBENV)
+            dfd = os.open(GRUB_DIR, os.O_RDONLY)
+            try:
+                os.fsync(dfd)
+            finally:
+                os.close(dfd)
+        except (OSError, ValueError) as e:
+            log.warning("grubenv commit failed: %s", e)
+            self._discard(job)
+            return False
+        self.job = None
+        trace("prep commit")
+        return True
+
+# --- Exit ---
+
+LINUX_REBOOT_CMD_RESTART = 0x01234567
+
+def status(msg):
+    # Clear + message in one write; nothing waits for the user to read it
+    if not sys.stdout.isatty():
+        return
+    sys.stdout.write(f"\033[2J\033[H{msg}\n")
+    sys.stdout.flush()
+
+def fast_reboot():
+    # Only /boot has to be on disk for GRUB; systemctl reboot flushes the
+    # rest during shutdown. reboot(2) skips that, so it still gets sync().
+    syncfs(GRUB_DIR)
+    if REBOOT_MODE == "syscall":
+        os.sync()
+    trace("sync done")
+    if TEST_MODE:
+        log.info("TEST_MODE: reboot skipped")
+        return
+    if REBOOT_MODE == "syscall" and _libc is not None:
+        trace("reboot(2)")
+        _libc.reboot(LINUX_REBOOT_CMD_RESTART)
+        log.error("reboot(2) failed (errno=%d), falling back to systemctl", ctypes.get_errno())
+    subprocess.run(["systemctl", "reboot", "--no-block"], check=False)
+    trace("handoff windows")
+
 # --- Menu ---
 
 def get_windows_entry():
     try:
-        with open("/boot/grub/grub.cfg") as f:
+        with open(GRUB_CFG) as f:
             for line in f:
                 if "menuentry" in line and "indows" in line:
                     s = line.find("'")
@@ -608,8 +1242,48 @@ def main():
     axis_info = {}
     gp_name = None
     grabbed = False
-
-    result = find_gamepad()
+    usb = UsbTuning()
+
+    isolate()
+    # grub.cfg and grubenv are read now, not on the first press under
+    # boot-time I/O
+    prep = WindowsPrep(get_windows_entry())
+
+    result = None
+    if BOOT_MODE and not display_connected():
+        # Same USB_WAIT as below: a pad or keyboard that enumerates late
+        # still gets the menu
+        while True:
+            result = find_gamepad()
+            if result or keyboard_present():
+                break
+            if time.monotonic() - T0 >= USB_WAIT:
+                # Nobody can see or answer the menu: no Plymouth quit, no VT
+                # switch, no countdown
+                log.info("Headless: no connected display, no gamepad/keyboard after %.1f s -> %s without menu",
+                         USB_WAIT, "Ubuntu" if DEFAULT_SEL == 0 else "Windows")
+                trace("headless skip")
+                finish(DEFAULT_SEL, prep)
+                return
+            time.sleep(0.25)
+
+    if BOOT_MODE:
+        boot_prep()
+
+    if not result:
+        result = find_gamepad()
+    if BOOT_MODE:
+        # Wait for USB only until a pad shows up (was a fixed sleep 2)
+        while not result and time.monotonic() - T0 < USB_WAIT:
+            time.sleep(0.25)
+            result = find_gamepad()
+    if result and USB_TUNING:
+        path = result[0].path
+        new = usb.apply(path)
+        if new != path:
+            # usbhid re-enlazado: el nodo viejo ya no sirve
+            result[0].close()
+            result = find_gamepad(new) if new else find_gamepad()
     if result:
         gp_dev, axis_info = result
         gp_name = gp_dev.name
@@ -626,28 +1300,48 @@ def main():
         log.warning("Keyboard setup failed: %s", e)
 
     selected = DEFAULT_SEL
+    if selected == 1:
+        prep.start()
     interrupted = False
     remaining = TIMEOUT
     last_time = time.time()
     prev = (-1, -1)
 
+    keyboard = KeyboardReader(sys.stdin.fileno())
+
+    trace("menu ready")
+    if BOOT_MODE:
+        log.info("Menu up %.0f ms after start (run.sh spent >= %.0f ms in fixed sleeps alone, plus chvt/plymouth/python forks)",
+                 (time.monotonic() - T0) * 1000, (USB_WAIT + 0.5 + 0.3) * 1000)
+
     try:
         while remaining > 0:
             cur = (selected, int(remaining))
             if cur != prev:
                 draw_menu(selected, int(remaining), gp_name)
+                trace("redraw", quiet=True)
                 prev = cur
 
-            action = read_gamepad(gp_dev, axis_info, 0.05)
+            # One wait for both sources
+            if not keyboard.pending:
+                fds = [f for f in (gp_dev.fd if gp_dev else None, keyboard.fd) if f is not None]
+                select.select(fds, [], [], 0.1)
+
+            action = read_gamepad(gp_dev, axis_info, 0)
             if not action:
-                action = read_keyboard(0.05)
+                action = keyboard.read()
+
+            if action:
+                trace(f"input {action}", quiet=True)
 
             if action == 'up':
                 selected = 0
                 remaining = TIMEOUT
+                prep.cancel()
             elif action == 'down':
                 selected = 1
                 remaining = TIMEOUT
+                prep.start()
             elif action == 'select':
                 log.info("Confirmed: %s", "Ubuntu" if selected == 0 else "Windows")
                 break
@@ -667,32 +1361,38 @@ def main():
                 gp_dev.ungrab()
             except Exception:
                 pass
+        usb.restore()
         if old_term:
             restore_keyboard(old_term)
 
     if interrupted:
+        prep.cancel()
         return
 
-    sys.stdout.write('\033[2J\033[H')
-    sys.stdout.flush()
+    finish(selected, prep)
 
+def finish(selected, prep):
     if selected == 1:
-        win = get_windows_entry()
+        trace("decision windows")
+        if prep.commit():
+            status(f"{C.CN}Reiniciando a Windows...{C.N}")
+            log.info("next_entry '%s' (prepared)", prep.entry)
+            fast_reboot()
+            return
+        prep.cancel()
+        win = prep.entry or get_windows_entry()
         if win:
-            print(f"{C.CN}Reiniciando a Windows...{C.N}")
+            status(f"{C.CN}Reiniciando a Windows...{C.N}")
             log.info("grub-reboot '%s'", win)
             subprocess.run(["grub-reboot", win], check=False)
-            time.sleep(1)
-            if not TEST_MODE:
-                subprocess.run(["reboot"], check=False)
-        else:
-            print(f"{C.Y}Windows no encontrado, iniciando Ubuntu...{C.N}")
-            time.sleep(2)
+            fast_reboot()
+            return
+        status(f"{C.Y}Windows no encontrado, iniciando Ubuntu...{C.N}")
     else:
-        print(f"{C.G}Iniciando Ubuntu...{C.N}")
+        trace("decision linux")
+        status(f"{C.G}Iniciando Ubuntu...{C.N}")
         log.info("Booting Ubuntu")
-
-    time.sleep(1)
+    trace("handoff linux")
 
 if __name__ == "__main__":
     try:
@@ -700,6 +1400,13 @@ if __name__ == "__main__":
     except Exception as e:
         log.exception("Fatal: %s", e)
         sys.exit(1)
+    finally:
+        if BOOT_MODE:
+            try:
+                open(FLAG, "w").close()
+                log.info("Flag created")
+            except OSError as e:
+                log.warning("Flag create failed: %s", e)
 PYEOF
 chmod +x /opt/boot-selector/selector.py
 
@@ -711,10 +1418,33 @@ step "4/5" "Inyectando en ${DM_SERVICE}..."
 DM_DROPIN_DIR="/etc/systemd/system/${DM_SERVICE}.d"
 mkdir -p "$DM_DROPIN_DIR"
 
-cat > "${DM_DROPIN_DIR}/boot-selector.conf" << 'DROPEOF'
+# Slice propia: el selector no compite en igualdad con el arranque del DM
+cat > /etc/systemd/system/boot-selector.slice << 'SLICEEOF'
+[Unit]
+Description=Boot Selector
+DefaultDependencies=no
+Before=slices.target
+
+[Slice]
+CPUWeight=1000
+IOWeight=1000
+SLICEEOF
+
+SELECTOR_CMD="/usr/bin/python3 /opt/boot-selector/selector.py --boot"
+SYSTEMD_RUN=$(command -v systemd-run || true)
+if [ -n "$SYSTEMD_RUN" ]; then
+    # Si systemd-run falla, el selector corre igual en el cgroup del DM
+    # (el flag evita una segunda ejecucion si el selector ya corrio)
+    cat > "${DM_DROPIN_DIR}/boot-selector.conf" << DROPEOF
 [Service]
-ExecStartPre=-/opt/boot-selector/run.sh
+ExecStartPre=-/bin/sh -c '${SYSTEMD_RUN} --scope --quiet --collect --slice=boot-selector.slice ${SELECTOR_CMD} || exec ${SELECTOR_CMD}'
 DROPEOF
+else
+    cat > "${DM_DROPIN_DIR}/boot-selector.conf" << DROPEOF
+[Service]
+ExecStartPre=-${SELECTOR_CMD}
+DROPEOF
+fi
 
 systemctl daemon-reload
 
@@ -743,6 +1473,7 @@ if [ -n "$DM_SERVICE" ]; then
     rm -f "/etc/systemd/system/${DM_SERVICE}.d/boot-selector.conf"
     rmdir "/etc/systemd/system/${DM_SERVICE}.d" 2>/dev/null || true
 fi
+rm -f /etc/systemd/system/boot-selector.slice
 systemctl daemon-reload
 rm -rf /opt/boot-selector
 rm -f /run/boot-selector-done
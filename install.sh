@@ -24,6 +24,16 @@ GRUB_MOD_DIR=""
 GRUB_PLATFORM=""
 BUILD_DIR="/tmp/grub-boot-selector-build-$$"
 
+# Extra GRUB commands packaged with the module
+EXTRA_MODULES="net_choice boot_schedule"
+
+# Module sources: copied from src/ next to this script in a checkout. The
+# release installer (make release) has SOURCES_EMBEDDED=1 and carries the
+# same files in write_source, so a `curl | bash` install builds exactly the
+# sources of that release.
+SOURCES_EMBEDDED=0
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]:-$0}")" && pwd)"
+
 ok() { echo -e "  ${GREEN}[OK]${NC} $1"; }
 err() { echo -e "  ${RED}[ERROR]${NC} $1"; }
 info() { echo -e "  ${CYAN}[INFO]${NC} $1"; }
@@ -44,6 +54,21 @@ step() {
     echo ""
 }
 
+# write_source NAME DEST: src/NAME.c -> DEST
+write_source() {
+    if [ "$SOURCES_EMBEDDED" != 1 ]; then
+        cp "$SCRIPT_DIR/src/$1.c" "$2"
+        return
+    fi
+    case "$1" in
+# @EMBEDDED_SOURCES@
+    *)
+        err "$1.c is not embedded in this installer"
+        return 1
+        ;;
+    esac
+}
+
 cleanup() {
     [ -d "$BUILD_DIR" ] && rm -rf "$BUILD_DIR" 2>/dev/null || true
 }
@@ -90,6 +115,16 @@ else
 fi
 ok "Platform: $GRUB_PLATFORM"
 
+if [ "$SOURCES_EMBEDDED" != 1 ]; then
+    for mod in usb_snes_gamepad $EXTRA_MODULES; do
+        if [ ! -f "$SCRIPT_DIR/src/$mod.c" ]; then
+            err "src/$mod.c not found next to this script"
+            echo "  Run install.sh from a checkout, or use the release installer"
+            exit 1
+        fi
+    done
+fi
+
 ########################################
 # STEP 2: Detect controller
 ########################################
@@ -254,232 +289,38 @@ ok "GRUB source downloaded"
 
 cd grub
 
-# Write our custom module source
-info "Creating usb_snes module..."
-
-cat > grub-core/term/usb_snes.c << 'MODSRC'
-/*
- *  GRUB USB SNES Gamepad - Based on working usb_keyboard.c
- *
- *  Key difference: Accepts HID devices with ANY subclass/protocol,
- *  not just keyboards (subclass=1, protocol=1).
- */
-
-#include <grub/term.h>
-#include <grub/time.h>
-#include <grub/misc.h>
-#include <grub/usb.h>
-#include <grub/dl.h>
-
-GRUB_MOD_LICENSE ("GPLv3+");
-
-#define USB_HID_SET_IDLE        0x0A
-#define USB_HID_SET_PROTOCOL    0x0B
-#define SNES_REPORT_SIZE 8
-#define AXIS_CENTER      0x7F
-#define AXIS_THRESHOLD   0x40
-#define MAX_GAMEPADS 8
-
-static struct {
-    grub_uint16_t vid;
-    grub_uint16_t pid;
-} supported_devices[] = {
-    {0x0810, 0xe501}, {0x0079, 0x0011}, {0x0583, 0x2060},
-    {0x2dc8, 0x9018}, {0x12bd, 0xd015}, {0x1a34, 0x0802},
-    {0x0810, 0x0001}, {0x0079, 0x0006}, {0x046d, 0xc218},
-    {0, 0}
-};
-
-struct grub_usb_snes_data {
-    grub_usb_device_t usbdev;
-    int interfno;
-    struct grub_usb_desc_endp *endp;
-    grub_usb_transfer_t transfer;
-    grub_uint8_t report[SNES_REPORT_SIZE];
-    grub_uint8_t prev_report[SNES_REPORT_SIZE];
-    int dead;
-    int key_queue[32];
-    int key_queue_head, key_queue_tail, key_queue_count;
-};
-
-static struct grub_term_input grub_usb_snes_terms[MAX_GAMEPADS];
-
-static void key_queue_push(struct grub_usb_snes_data *d, int k) {
-    if (d->key_queue_count >= 32 || k == GRUB_TERM_NO_KEY) return;
-    d->key_queue[d->key_queue_tail] = k;
-    d->key_queue_tail = (d->key_queue_tail + 1) % 32;
-    d->key_queue_count++;
-}
-
-static int key_queue_pop(struct grub_usb_snes_data *d) {
-    if (d->key_queue_count <= 0) return GRUB_TERM_NO_KEY;
-    int k = d->key_queue[d->key_queue_head];
-    d->key_queue_head = (d->key_queue_head + 1) % 32;
-    d->key_queue_count--;
-    return k;
-}
-
-static int is_supported(grub_uint16_t v, grub_uint16_t p) {
-    for (int i = 0; supported_devices[i].vid; i++)
-        if (supported_devices[i].vid == v && supported_devices[i].pid == p)
-            return 1;
-    return 0;
-}
-
-static void parse_report(struct grub_usb_snes_data *d) {
-    grub_uint8_t *p = d->prev_report, *c = d->report;
-
-    int pu = (p[1] < AXIS_CENTER - AXIS_THRESHOLD);
-    int pd = (p[1] > AXIS_CENTER + AXIS_THRESHOLD);
-    int pl = (p[0] < AXIS_CENTER - AXIS_THRESHOLD);
-    int pr = (p[0] > AXIS_CENTER + AXIS_THRESHOLD);
-    int cu = (c[1] < AXIS_CENTER - AXIS_THRESHOLD);
-    int cd = (c[1] > AXIS_CENTER + AXIS_THRESHOLD);
-    int cl = (c[0] < AXIS_CENTER - AXIS_THRESHOLD);
-    int cr = (c[0] > AXIS_CENTER + AXIS_THRESHOLD);
-
-    if (!pu && cu) key_queue_push(d, GRUB_TERM_KEY_UP);
-    if (!pd && cd) key_queue_push(d, GRUB_TERM_KEY_DOWN);
-    if (!pl && cl) key_queue_push(d, GRUB_TERM_KEY_LEFT);
-    if (!pr && cr) key_queue_push(d, GRUB_TERM_KEY_RIGHT);
-
-    grub_uint8_t pb = p[4], cb = c[4];
-    if (!(pb & 0x02) && (cb & 0x02)) key_queue_push(d, '\r');  /* A */
-    if (!(pb & 0x04) && (cb & 0x04)) key_queue_push(d, GRUB_TERM_ESC); /* B */
-    if (!(pb & 0x80) && (cb & 0x80)) key_queue_push(d, '\r');  /* Start */
-    if (!(pb & 0x40) && (cb & 0x40)) key_queue_push(d, GRUB_TERM_ESC); /* Select */
-    if (!(pb & 0x10) && (cb & 0x10)) key_queue_push(d, GRUB_TERM_KEY_PPAGE); /* L */
-    if (!(pb & 0x20) && (cb & 0x20)) key_queue_push(d, GRUB_TERM_KEY_NPAGE); /* R */
-}
-
-static int grub_usb_snes_getkey(struct grub_term_input *t) {
-    struct grub_usb_snes_data *d = t->data;
-    grub_size_t actual;
-
-    if (d->dead) return GRUB_TERM_NO_KEY;
-    if (d->key_queue_count > 0) return key_queue_pop(d);
-
-    grub_usb_err_t err = grub_usb_check_transfer(d->transfer, &actual);
-    if (err == GRUB_USB_ERR_WAIT) return GRUB_TERM_NO_KEY;
-
-    if (err == GRUB_USB_ERR_NONE && actual >= 1) {
-        parse_report(d);
-        grub_memcpy(d->prev_report, d->report, SNES_REPORT_SIZE);
-    }
-
-    d->transfer = grub_usb_bulk_read_background(d->usbdev, d->endp,
-        sizeof(d->report), (char *)d->report);
-    if (!d->transfer) { d->dead = 1; return GRUB_TERM_NO_KEY; }
-
-    return key_queue_pop(d);
-}
-
-static int grub_usb_snes_getkeystatus(struct grub_term_input *t __attribute__((unused))) {
-    return 0;
-}
-
-static void grub_usb_snes_detach(grub_usb_device_t usbdev,
-    int config __attribute__((unused)), int iface __attribute__((unused))) {
-    for (unsigned i = 0; i < MAX_GAMEPADS; i++) {
-        struct grub_usb_snes_data *d = grub_usb_snes_terms[i].data;
-        if (!d || d->usbdev != usbdev) continue;
-        if (d->transfer) grub_usb_cancel_transfer(d->transfer);
-        grub_term_unregister_input(&grub_usb_snes_terms[i]);
-        grub_free((char *)grub_usb_snes_terms[i].name);
-        grub_usb_snes_terms[i].name = NULL;
-        grub_free(d);
-        grub_usb_snes_terms[i].data = NULL;
-    }
-}
-
-static int grub_usb_snes_attach(grub_usb_device_t usbdev, int configno, int interfno) {
-    if (!is_supported(usbdev->descdev.vendorid, usbdev->descdev.prodid))
-        return 0;
-
-    unsigned curnum;
-    for (curnum = 0; curnum < MAX_GAMEPADS; curnum++)
-        if (!grub_usb_snes_terms[curnum].data) break;
-    if (curnum == MAX_GAMEPADS) return 0;
-
-    struct grub_usb_desc_endp *endp = NULL;
-    for (int j = 0; j < usbdev->config[configno].interf[interfno].descif->endpointcnt; j++) {
-        endp = &usbdev->config[configno].interf[interfno].descendp[j];
-        if ((endp->endp_addr & 128) && grub_usb_get_ep_type(endp) == GRUB_USB_EP_INTERRUPT)
-            break;
-    }
-    if (!endp) return 0;
-
-    struct grub_usb_snes_data *d = grub_malloc(sizeof(*d));
-    if (!d) return 0;
-    grub_memset(d, 0, sizeof(*d));
-    d->usbdev = usbdev;
-    d->interfno = interfno;
-    d->endp = endp;
-    d->prev_report[0] = d->prev_report[1] = AXIS_CENTER;
-
-    /* CRITICAL: HID initialization from working usb_keyboard.c */
-    grub_usb_set_configuration(usbdev, configno + 1);
-    grub_usb_control_msg(usbdev, GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT,
-        USB_HID_SET_PROTOCOL, 0, interfno, 0, 0);
-    grub_usb_control_msg(usbdev, GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT,
-        USB_HID_SET_IDLE, 0, interfno, 0, 0);
-
-    grub_usb_snes_terms[curnum].name = grub_xasprintf("usb_snes%d", curnum);
-    grub_usb_snes_terms[curnum].getkey = grub_usb_snes_getkey;
-    grub_usb_snes_terms[curnum].getkeystatus = grub_usb_snes_getkeystatus;
-    grub_usb_snes_terms[curnum].data = d;
-    grub_usb_snes_terms[curnum].next = 0;
-
-    usbdev->config[configno].interf[interfno].detach_hook = grub_usb_snes_detach;
-
-    d->transfer = grub_usb_bulk_read_background(usbdev, d->endp,
-        sizeof(d->report), (char *)d->report);
-    if (!d->transfer) { grub_free(d); return 0; }
-
-    grub_term_register_input_active("usb_snes", &grub_usb_snes_terms[curnum]);
-    grub_printf("SNES gamepad connected!\n");
-    return 1;
-}
-
-static struct grub_usb_attach_desc attach_hook = {
-    .class = GRUB_USB_CLASS_HID,
-    .hook = grub_usb_snes_attach
-};
-
-GRUB_MOD_INIT(usb_snes) {
-    grub_usb_register_attach_hook_class(&attach_hook);
-}
-
-GRUB_MOD_FINI(usb_snes) {
-    for (unsigned i = 0; i < MAX_GAMEPADS; i++) {
-        struct grub_usb_snes_data *d = grub_usb_snes_terms[i].data;
-        if (!d) continue;
-        if (d->transfer) grub_usb_cancel_transfer(d->transfer);
-        grub_term_unregister_input(&grub_usb_snes_terms[i]);
-        grub_free((char *)grub_usb_snes_terms[i].name);
-        grub_free(d);
-        grub_usb_snes_terms[i].data = NULL;
-    }
-    grub_usb_unregister_attach_hook_class(&attach_hook);
-}
-MODSRC
-
+# Gamepad module: the same src/usb_snes_gamepad.c docs/grub-module.md
+# describes (macros, quirks, idle calibration)
+info "Creating usb_snes_gamepad module source..."
+write_source usb_snes_gamepad grub-core/term/usb_snes_gamepad.c
 ok "Module source created"
 
+info "Creating extra command sources..."
+for mod in $EXTRA_MODULES; do
+    write_source "$mod" "grub-core/commands/$mod.c"
+done
+ok "Extra command sources created"
+
 # Add to GRUB build system
 info "Configuring build system..."
 
 # Add module to Makefile.core.def
-if ! grep -q "usb_snes" grub-core/Makefile.core.def 2>/dev/null; then
+if ! grep -q "name = usb_snes_gamepad;" grub-core/Makefile.core.def 2>/dev/null; then
     cat >> grub-core/Makefile.core.def << 'MAKEDEF'
 
 module = {
-  name = usb_snes;
-  common = term/usb_snes.c;
+  name = usb_snes_gamepad;
+  common = term/usb_snes_gamepad.c;
   enable = usb;
 };
 MAKEDEF
 fi
+for mod in $EXTRA_MODULES; do
+    if [ -f "grub-core/commands/$mod.c" ] && ! grep -q "name = $mod;" grub-core/Makefile.core.def; then
+        printf '\nmodule = {\n  name = %s;\n  common = commands/%s.c;\n};\n' "$mod" "$mod" \
+            >> grub-core/Makefile.core.def
+    fi
+done
 ok "Build system configured"
 
 # Bootstrap
@@ -516,11 +357,7 @@ fi
 ok "Compile complete"
 
 # Find and copy module
-MOD=$(find . -name "usb_snes.mod" -type f 2>/dev/null | head -1)
-if [ -z "$MOD" ]; then
-    warn "usb_snes.mod not found, looking for usb_gamepad.mod..."
-    MOD=$(find . -name "usb_gamepad.mod" -type f 2>/dev/null | head -1)
-fi
+MOD=$(find . -name "usb_snes_gamepad.mod" -type f 2>/dev/null | head -1)
 
 if [ -z "$MOD" ]; then
     err "No gamepad module found!"
@@ -529,9 +366,18 @@ if [ -z "$MOD" ]; then
     exit 1
 fi
 
-cp "$MOD" "$GRUB_MOD_DIR/usb_snes.mod"
-chmod 644 "$GRUB_MOD_DIR/usb_snes.mod"
-ok "Module installed: $GRUB_MOD_DIR/usb_snes.mod"
+cp "$MOD" "$GRUB_MOD_DIR/usb_snes_gamepad.mod"
+chmod 644 "$GRUB_MOD_DIR/usb_snes_gamepad.mod"
+ok "Module installed: $GRUB_MOD_DIR/usb_snes_gamepad.mod"
+
+for mod in $EXTRA_MODULES; do
+    EXTRA=$(find . -name "$mod.mod" -type f 2>/dev/null | head -1)
+    if [ -n "$EXTRA" ]; then
+        cp "$EXTRA" "$GRUB_MOD_DIR/$mod.mod"
+        chmod 644 "$GRUB_MOD_DIR/$mod.mod"
+        ok "Module installed: $GRUB_MOD_DIR/$mod.mod"
+    fi
+done
 
 ########################################
 # STEP 5: Configure GRUB
@@ -546,8 +392,21 @@ if [ ! -f "${GRUB_CUSTOM}.backup-snes" ]; then
     ok "Backed up GRUB config"
 fi
 
+# Upgrade from the old usb_snes module: it has no idle calibration (phantom
+# keys from pads that rest with a nonzero byte) and must not stay loaded
+if grep -q "^insmod usb_snes$" "$GRUB_CUSTOM" 2>/dev/null; then
+    sed -i -e 's/^insmod usb_snes$/insmod usb_snes_gamepad/' \
+        -e '/^# Register gamepad as input$/d' \
+        -e '/^terminal_input --append usb_snes$/d' "$GRUB_CUSTOM"
+    ok "Replaced usb_snes with usb_snes_gamepad in GRUB config"
+fi
+if [ -f "$GRUB_MOD_DIR/usb_snes.mod" ]; then
+    rm -f "$GRUB_MOD_DIR/usb_snes.mod"
+    ok "Removed old module: $GRUB_MOD_DIR/usb_snes.mod"
+fi
+
 # Add gamepad configuration
-if ! grep -q "usb_snes" "$GRUB_CUSTOM" 2>/dev/null; then
+if ! grep -q "^insmod usb_snes_gamepad" "$GRUB_CUSTOM" 2>/dev/null; then
     cat >> "$GRUB_CUSTOM" << 'GRUBEOF'
 
 # ========================================
@@ -562,17 +421,27 @@ insmod xhci
 # Load USB stack
 insmod usb
 
-# Load SNES gamepad module
-insmod usb_snes
-
-# Register gamepad as input
-terminal_input --append usb_snes
+# Load SNES gamepad module; each pad becomes an active input
+# (snes_gamepadN) as it attaches, no terminal_input needed
+insmod usb_snes_gamepad
 GRUBEOF
     ok "Added SNES config to GRUB"
 else
     info "GRUB already configured"
 fi
 
+# Calendar-based default: no-op until boot_schedule is set in grubenv
+if [ -f "$GRUB_MOD_DIR/boot_schedule.mod" ] && ! grep -q "schedule_default" "$GRUB_CUSTOM" 2>/dev/null; then
+    cat >> "$GRUB_CUSTOM" << 'GRUBEOF'
+
+# Calendar-based default entry (grub-editenv - set boot_schedule=...)
+if insmod boot_schedule; then
+    schedule_default
+fi
+GRUBEOF
+    ok "Added boot schedule hook to GRUB"
+fi
+
 # Update GRUB
 info "Updating GRUB..."
 if command -v update-grub &>/dev/null; then
@@ -596,23 +465,46 @@ echo -e "${GREEN}${BOLD}================================================${NC}"
 echo -e "${GREEN}${BOLD}          Installation Complete!                ${NC}"
 echo -e "${GREEN}${BOLD}================================================${NC}"
 echo ""
-echo "  Module: $GRUB_MOD_DIR/usb_snes.mod"
+echo "  Module: $GRUB_MOD_DIR/usb_snes_gamepad.mod"
 echo ""
 echo "  Controls:"
 echo "    D-pad Up/Down    -> Navigate menu"
 echo "    D-pad Left/Right -> Submenus"
 echo "    A / Start        -> Select (Enter)"
-echo "    B / Select       -> Back (Escape)"
+echo "    B / Y            -> Back (Escape)"
+echo "    Select           -> Edit entry (e)"
+echo "    X                -> Command line (c)"
 echo "    L / R            -> Page Up/Down"
 echo ""
+echo "  Button-chord macros (see docs/grub-module.md):"
+echo "    sudo grub-editenv - set 'snes_macro_a_l_r=e{down}{down}{down}{end} single{f10}'"
+echo ""
 echo -e "  ${CYAN}${BOLD}Reboot to test!${NC}"
 echo ""
 echo "  Debug (in GRUB press 'c'):"
 echo "    set debug=usb_snes"
-echo "    terminal_input usb_snes"
+echo "    snes_status"
+if [ -n "$VID" ] && [ -n "$PID" ]; then
+    echo ""
+    echo "  If snes_status shows a slow SET_PROTOCOL/SET_IDLE for this pad:"
+    echo "    sudo grub-editenv - set snes_quirks_${VID}_${PID}=noprotocol,noidle"
+fi
+echo ""
+echo "  Network boot choice (see docs/grub-module.md):"
+echo "    insmod net_choice"
+echo "    net_bootp"
+echo "    netchoice --server 192.168.1.10"
+echo ""
+echo "  Calendar default (Windows by day, Linux at night):"
+echo "    sudo grub-editenv - set boot_schedule='mo-fr/0800-1900=2 *=0'"
 echo ""
 echo "  Uninstall:"
-echo "    sudo rm $GRUB_MOD_DIR/usb_snes.mod"
+echo "    sudo rm $GRUB_MOD_DIR/usb_snes_gamepad.mod"
+for mod in $EXTRA_MODULES; do
+    if [ -f "$GRUB_MOD_DIR/$mod.mod" ]; then
+        echo "    sudo rm $GRUB_MOD_DIR/$mod.mod"
+    fi
+done
 echo "    sudo cp ${GRUB_CUSTOM}.backup-snes $GRUB_CUSTOM"
 echo "    sudo update-grub"
 echo ""
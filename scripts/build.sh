@@ -7,6 +7,17 @@ SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
 GRUB_DIR="$PROJECT_DIR/grub"
 
+# Extra GRUB command modules shipped in src/ (built next to the gamepad module)
+EXTRA_MODULES="net_choice boot_schedule"
+
+# Out-of-tree builds, one per platform. EFI=1 (or OVMF=<firmware>, as for
+# test-qemu.sh) also builds x86_64-efi and adds it to the ISO.
+BUILD_PC="$GRUB_DIR/build-i386-pc"
+BUILD_EFI="$GRUB_DIR/build-x86_64-efi"
+if [ -n "$EFI" ] || [ -n "$OVMF" ]; then
+    WITH_EFI=1
+fi
+
 echo "=== Building GRUB Boot Selector Module ==="
 
 # Check if GRUB submodule exists
@@ -21,7 +32,10 @@ fi
 
 # Check dependencies
 echo "Checking dependencies..."
-DEPS="build-essential autoconf automake gettext bison flex"
+DEPS="build-essential autoconf automake gettext bison flex xorriso"
+if [ -n "$WITH_EFI" ]; then
+    DEPS="$DEPS mtools"
+fi
 MISSING=""
 for dep in $DEPS; do
     if ! dpkg -l | grep -q "^ii  $dep"; then
@@ -38,35 +52,82 @@ fi
 # Build GRUB
 cd "$GRUB_DIR"
 
-if [ ! -f "configure" ]; then
-    echo "Running bootstrap..."
-    ./bootstrap
+# Register our modules (regenerate the build system when the list changes)
+cp "$PROJECT_DIR/src/usb_snes_gamepad.c" "$GRUB_DIR/grub-core/term/"
+if ! grep -q "name = usb_snes_gamepad;" grub-core/Makefile.core.def; then
+    echo "Registering usb_snes_gamepad module..."
+    printf '\nmodule = {\n  name = usb_snes_gamepad;\n  common = term/usb_snes_gamepad.c;\n  enable = usb;\n};\n' \
+        >> grub-core/Makefile.core.def
+    rm -f configure
 fi
+for mod in $EXTRA_MODULES; do
+    cp "$PROJECT_DIR/src/$mod.c" "$GRUB_DIR/grub-core/commands/"
+    if ! grep -q "name = $mod;" grub-core/Makefile.core.def; then
+        echo "Registering $mod module..."
+        printf '\nmodule = {\n  name = %s;\n  common = commands/%s.c;\n};\n' "$mod" "$mod" \
+            >> grub-core/Makefile.core.def
+        rm -f configure
+    fi
+done
 
-if [ ! -f "Makefile" ]; then
-    echo "Running configure..."
-    ./configure
+# Out-of-tree configure refuses a source tree configured in place (older
+# versions of this script did that)
+if [ -f "config.status" ]; then
+    echo "Cleaning in-tree build..."
+    make distclean
 fi
 
-echo "Building GRUB..."
-make -j$(nproc)
+if [ ! -f "configure" ]; then
+    echo "Running bootstrap..."
+    ./bootstrap
+    rm -f "$BUILD_PC/Makefile" "$BUILD_EFI/Makefile"
+fi
 
-# Copy our module source
-echo "Copying SNES gamepad module..."
-cp "$PROJECT_DIR/src/usb_snes_gamepad.c" "$GRUB_DIR/grub-core/term/"
+# build_platform DIR CONFIGURE_ARGS...
+build_platform() {
+    local dir="$1"
+    shift
+    mkdir -p "$dir"
+    cd "$dir"
+    if [ ! -f "Makefile" ]; then
+        echo "Running configure $*..."
+        "$GRUB_DIR/configure" "$@"
+    fi
+    echo "Building GRUB ($(basename "$dir"))..."
+    make -j$(nproc)
+    cd "$GRUB_DIR"
+}
 
-# Rebuild with our module
-echo "Rebuilding with SNES module..."
-make -j$(nproc)
+build_platform "$BUILD_PC" --with-platform=pc --target=i386
+MKRESCUE_DIRS=(-d "$BUILD_PC/grub-core")
+if [ -n "$WITH_EFI" ]; then
+    build_platform "$BUILD_EFI" --with-platform=efi --target=x86_64
+    MKRESCUE_DIRS+=(-d "$BUILD_EFI/grub-core")
+fi
 
-# Create test ISO
+# Create test ISO (grub-mkrescue takes one -d per platform). The ISO
+# carries every module; iso/ only needs a grub.cfg.
 echo "Creating test ISO..."
 cd "$PROJECT_DIR"
-"$GRUB_DIR/grub-mkrescue" -o test.iso iso/
+if [ ! -d iso ]; then
+    mkdir -p iso/boot/grub
+    cat > iso/boot/grub/grub.cfg << 'CFGEOF'
+insmod usb_snes_gamepad
+set timeout=-1
+menuentry "Reboot" { reboot }
+CFGEOF
+fi
+"$BUILD_PC/grub-mkrescue" "${MKRESCUE_DIRS[@]}" -o test.iso iso/
 
 echo ""
 echo "=== Build Complete ==="
-echo "Test ISO: $PROJECT_DIR/test.iso"
-echo "Module: $GRUB_DIR/grub-core/term/usb_snes_gamepad.mod"
+echo "Test ISO: $PROJECT_DIR/test.iso (i386-pc${WITH_EFI:+, x86_64-efi})"
+echo "Module: $BUILD_PC/grub-core/usb_snes_gamepad.mod"
+for mod in $EXTRA_MODULES; do
+    echo "Module: $BUILD_PC/grub-core/$mod.mod"
+done
+if [ -n "$WITH_EFI" ]; then
+    echo "EFI modules: $BUILD_EFI/grub-core/"
+fi
 echo ""
 echo "To test: ./scripts/test-qemu.sh"
@@ -0,0 +1,52 @@
+#!/bin/bash
+# Build the release installer: install.sh with the GRUB module sources from
+# src/ embedded, so `curl .../releases/latest/download/install.sh | bash`
+# builds exactly the sources of the release. Upload dist/install.sh as the
+# release asset.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+OUT="$PROJECT_DIR/dist/install.sh"
+
+# Every module install.sh builds from src/ (write_source callers)
+SOURCES="usb_snes_gamepad net_choice boot_schedule"
+
+mkdir -p "$(dirname "$OUT")"
+
+python3 - "$PROJECT_DIR" "$OUT" $SOURCES << 'PYEOF'
+import os, sys
+
+project, out, names = sys.argv[1], sys.argv[2], sys.argv[3:]
+MARKER = "# @EMBEDDED_SOURCES@"
+
+with open(os.path.join(project, "install.sh")) as f:
+    script = f.read()
+if script.count(MARKER) != 1 or script.count("\nSOURCES_EMBEDDED=0\n") != 1:
+    sys.exit("install.sh: embed marker or SOURCES_EMBEDDED=0 missing")
+
+arms = []
+for name in names:
+    with open(os.path.join(project, "src", name + ".c")) as f:
+        src = f.read()
+    delim = "SRC_" + name.upper()
+    if delim in src:
+        sys.exit(f"src/{name}.c contains the heredoc delimiter {delim}")
+    if not src.endswith("\n"):
+        src += "\n"
+    arms.append(f"    {name})\n        cat > \"$2\" << '{delim}'\n{src}{delim}\n        ;;")
+
+script = script.replace(MARKER, "\n".join(arms))
+script = script.replace("\nSOURCES_EMBEDDED=0\n", "\nSOURCES_EMBEDDED=1\n")
+with open(out, "w") as f:
+    f.write(script)
+PYEOF
+
+chmod +x "$OUT"
+bash -n "$OUT"
+
+echo "Release installer: $OUT"
+for name in $SOURCES; do
+    echo "  embedded src/$name.c"
+done
@@ -11,6 +11,26 @@ if [ ! -f "$ISO" ]; then
     exit 1
 fi
 
+# Optional: NET=1 adds user networking (the host is 10.0.2.2 in the guest),
+# OVMF=<firmware image> boots UEFI instead of SeaBIOS. NET needs OVMF: the
+# i386-pc GRUB only has a network card when it was itself booted over PXE.
+if [ -n "$NET" ] && [ -z "$OVMF" ]; then
+    echo "NET=1 needs OVMF=<firmware image> (efinet is EFI-only)"
+    exit 1
+fi
+if [ -n "$OVMF" ] && ! xorriso -indev "$ISO" -find /efi.img 2>/dev/null | grep -q efi.img; then
+    echo "Test ISO has no EFI image. Run EFI=1 ./scripts/build.sh first"
+    exit 1
+fi
+
+QEMU_EXTRA=()
+if [ -n "$NET" ]; then
+    QEMU_EXTRA+=(-nic user,model=virtio-net-pci)
+fi
+if [ -n "$OVMF" ]; then
+    QEMU_EXTRA+=(-bios "$OVMF")
+fi
+
 echo "=== Testing GRUB Boot Selector in QEMU ==="
 echo ""
 echo "Connect your SNES controller before running this."
@@ -27,7 +47,8 @@ if [ -z "$CONTROLLER" ]; then
         -cdrom "$ISO" \
         -m 256M \
         -enable-kvm \
-        -vga std
+        -vga std \
+        "${QEMU_EXTRA[@]}"
 else
     echo "Found: $CONTROLLER"
 
@@ -49,7 +70,8 @@ else
         -enable-kvm \
         -vga std \
         -usb \
-        -device usb-host,vendorid=0x${VIDPID%%:*},productid=0x${VIDPID##*:}
+        -device usb-host,vendorid=0x${VIDPID%%:*},productid=0x${VIDPID##*:} \
+        "${QEMU_EXTRA[@]}"
 fi
 
 echo ""
@@ -57,6 +79,10 @@ echo "=== QEMU Commands in GRUB Shell ==="
 echo "Once GRUB loads, try these commands:"
 echo ""
 echo "  insmod usb_snes_gamepad"
-echo "  terminal_input usb_snes_gamepad"
 echo "  snes_status"
 echo ""
+if [ -n "$NET" ]; then
+    echo "  insmod efinet; net_bootp; insmod net_choice"
+    echo "  netchoice --server 10.0.2.2   (run tools/netchoice-server.py on the host)"
+    echo ""
+fi
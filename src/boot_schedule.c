@@ -0,0 +1,266 @@
+/*
+ * GRUB Calendar Default
+ *
+ * Picks the default menu entry from the RTC and a compact schedule kept in
+ * grubenv, before the menu appears, so the right OS boots without a detour
+ * through Linux and a reboot.
+ *
+ *   schedule_default [SCHEDULE]
+ *
+ * SCHEDULE (default: $boot_schedule) is a space separated list of rules,
+ * first match wins:
+ *
+ *   DAYS[/HHMM-HHMM]=ENTRY
+ *
+ *   DAYS   *  or day names su mo tu we th fr sa, comma lists and ranges
+ *          (mo-fr, sa,su, fr-mo)
+ *   HHMM   start inclusive, end exclusive; 2200-0600 wraps past midnight
+ *          (both parts are matched against the current day)
+ *   ENTRY  menu index, id or title without spaces
+ *
+ *   boot_schedule="mo-fr/0800-1900=2 *=0"
+ *
+ * The RTC is read as local time; set boot_schedule_utc_offset (minutes,
+ * e.g. -180) when the RTC runs on UTC, as Linux-only machines do.
+ * A one-shot grub-reboot (boot_once=true) is never overridden.
+ *
+ * License: GPLv3+
+ */
+
+#include <grub/dl.h>
+#include <grub/misc.h>
+#include <grub/env.h>
+#include <grub/command.h>
+#include <grub/datetime.h>
+#include <grub/i18n.h>
+
+GRUB_MOD_LICENSE ("GPLv3+");
+
+#define MINUTES_PER_DAY   (24 * 60)
+#define ALL_DAYS          0x7f
+
+static const char *const day_names[7] = {
+    "su", "mo", "tu", "we", "th", "fr", "sa"
+};
+
+/*
+ * Day of week, 0 = Sunday (Sakamoto's method)
+ */
+static int
+weekday (int year, int month, int day)
+{
+    static const int t[12] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+    if (month < 3)
+        year--;
+    return (year + year / 4 - year / 100 + year / 400 + t[month - 1] + day) % 7;
+}
+
+static int
+parse_day (const char **p)
+{
+    int i;
+
+    for (i = 0; i < 7; i++)
+    {
+        if (grub_strncmp (*p, day_names[i], 2) == 0)
+        {
+            *p += 2;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * "mo-fr,su" -> bitmask (bit 0 = Sunday), -1 on syntax error
+ */
+static int
+parse_days (const char *p, const char *end)
+{
+    int mask = 0;
+
+    if (p + 1 == end && *p == '*')
+        return ALL_DAYS;
+
+    while (p < end)
+    {
+        int first = parse_day (&p);
+        int last = first;
+
+        if (first < 0)
+            return -1;
+        if (p < end && *p == '-')
+        {
+            p++;
+            last = parse_day (&p);
+            if (last < 0)
+                return -1;
+        }
+        for (;;)
+        {
+            mask |= 1 << first;
+            if (first == last)
+                break;
+            first = (first + 1) % 7;
+        }
+        if (p < end && *p != ',')
+            return -1;
+        if (p < end)
+            p++;
+    }
+    return mask;
+}
+
+/*
+ * "HHMM" -> minutes since midnight, -1 on syntax error
+ */
+static int
+parse_hhmm (const char *p)
+{
+    int i, v = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (!grub_isdigit (p[i]))
+            return -1;
+        v = v * 10 + (p[i] - '0');
+    }
+    if ((v / 100 > 23 && v != 2400) || v % 100 > 59)
+        return -1;
+    return (v / 100) * 60 + v % 100;
+}
+
+/*
+ * Does RULE's left side ("DAYS[/HHMM-HHMM]", ending at END) cover the time?
+ * Returns 1 on match, 0 on no match, -1 on syntax error
+ */
+static int
+rule_matches (const char *rule, const char *end, int wday, int minute)
+{
+    const char *slash = rule;
+    int days, from, to;
+
+    while (slash < end && *slash != '/')
+        slash++;
+
+    days = parse_days (rule, slash);
+    if (days < 0)
+        return -1;
+    if (!(days & (1 << wday)))
+        return 0;
+    if (slash == end)
+        return 1;
+
+    if (end - slash != 10 || slash[5] != '-')
+        return -1;
+    from = parse_hhmm (slash + 1);
+    to = parse_hhmm (slash + 6);
+    if (from < 0 || to < 0)
+        return -1;
+
+    if (from <= to)
+        return minute >= from && minute < to;
+    return minute >= from || minute < to;
+}
+
+static grub_err_t
+grub_cmd_schedule_default (grub_command_t cmd __attribute__ ((unused)),
+                           int argc, char **args)
+{
+    struct grub_datetime dt;
+    const char *schedule;
+    const char *once;
+    const char *offset;
+    char *copy, *p;
+    int wday, minute;
+
+    schedule = argc > 0 ? args[0] : grub_env_get ("boot_schedule");
+    if (!schedule || !*schedule)
+        return GRUB_ERR_NONE;
+
+    once = grub_env_get ("boot_once");
+    if (once && grub_strcmp (once, "true") == 0)
+    {
+        grub_dprintf ("schedule", "One-shot boot pending, schedule ignored\n");
+        return GRUB_ERR_NONE;
+    }
+
+    if (grub_get_datetime (&dt))
+        return grub_errno;
+
+    wday = weekday (dt.year, dt.month, dt.day);
+    minute = dt.hour * 60 + dt.minute;
+
+    offset = grub_env_get ("boot_schedule_utc_offset");
+    if (offset)
+        minute += grub_strtol (offset, 0, 10);
+    while (minute < 0)
+    {
+        minute += MINUTES_PER_DAY;
+        wday = (wday + 6) % 7;
+    }
+    while (minute >= MINUTES_PER_DAY)
+    {
+        minute -= MINUTES_PER_DAY;
+        wday = (wday + 1) % 7;
+    }
+
+    grub_dprintf ("schedule", "Now: %s %02d:%02d\n", day_names[wday],
+                  minute / 60, minute % 60);
+
+    copy = grub_strdup (schedule);
+    if (!copy)
+        return grub_errno;
+
+    for (p = copy; *p; )
+    {
+        char *rule, *eq, *entry;
+        int m;
+
+        while (*p == ' ')
+            p++;
+        if (!*p)
+            break;
+        rule = p;
+        while (*p && *p != ' ')
+            p++;
+        if (*p)
+            *p++ = '\0';
+
+        eq = grub_strchr (rule, '=');
+        if (!eq || eq == rule || !eq[1])
+        {
+            grub_dprintf ("schedule", "Bad rule `%s'\n", rule);
+            continue;
+        }
+        entry = eq + 1;
+
+        m = rule_matches (rule, eq, wday, minute);
+        if (m < 0)
+            grub_dprintf ("schedule", "Bad rule `%s'\n", rule);
+        if (m > 0)
+        {
+            grub_dprintf ("schedule", "Rule `%s' -> default=%s\n", rule, entry);
+            grub_env_set ("default", entry);
+            break;
+        }
+    }
+
+    grub_free (copy);
+    return GRUB_ERR_NONE;
+}
+
+static grub_command_t cmd;
+
+GRUB_MOD_INIT (boot_schedule)
+{
+    cmd = grub_register_command ("schedule_default", grub_cmd_schedule_default,
+                                 N_("[SCHEDULE]"),
+                                 N_("Set the default entry from the RTC and $boot_schedule."));
+}
+
+GRUB_MOD_FINI (boot_schedule)
+{
+    grub_unregister_command (cmd);
+}
@@ -0,0 +1,211 @@
+/*
+ * GRUB Network Boot Choice
+ *
+ * Lets a machine on the network pick the menu entry to boot, for headless
+ * rigs where no gamepad is in reach.
+ *
+ *   netchoice [--server ADDR] [--port PORT] [--timeout MS]
+ *
+ * During the listen window the command sends a short request datagram
+ * ("BOOTSEL? <netchoice_id>") to the boot-choice server every
+ * NETCHOICE_RETRY_MS.  The payload of the first reply is the menu entry to
+ * boot (title, id or index): `default` is set to it and `timeout` to 0, so
+ * the menu boots it at once instead of counting down.
+ *
+ * Request/reply rather than a bare listener because GRUB's UDP sockets
+ * only accept datagrams from the peer they were opened to, and because it
+ * lets replies traverse NAT (QEMU user networking, home routers).
+ *
+ * The network card must be configured first (net_bootp / net_dhcp or
+ * net_add_addr).  Server side: tools/netchoice-server.py
+ *
+ * License: GPLv3+
+ */
+
+#include <grub/dl.h>
+#include <grub/misc.h>
+#include <grub/env.h>
+#include <grub/time.h>
+#include <grub/term.h>
+#include <grub/extcmd.h>
+#include <grub/i18n.h>
+#include <grub/net.h>
+#include <grub/net/udp.h>
+#include <grub/net/netbuff.h>
+
+GRUB_MOD_LICENSE ("GPLv3+");
+
+/*
+ * Defaults
+ */
+#define NETCHOICE_PORT          7373
+#define NETCHOICE_WINDOW_MS     3000
+#define NETCHOICE_RETRY_MS      250
+#define NETCHOICE_ENTRY_MAX     128
+#define NETCHOICE_REQUEST       "BOOTSEL?"
+
+static const struct grub_arg_option options[] = {
+    {"server",  's', 0, N_("Boot-choice server (default: $netchoice_server)."),
+     N_("ADDR"), ARG_TYPE_STRING},
+    {"port",    'p', 0, N_("UDP port (default: 7373)."),
+     N_("PORT"), ARG_TYPE_INT},
+    {"timeout", 't', 0, N_("Listen window in milliseconds (default: 3000)."),
+     N_("MS"), ARG_TYPE_INT},
+    {0, 0, 0, 0, 0, 0}
+};
+
+enum
+{
+    OPTION_SERVER,
+    OPTION_PORT,
+    OPTION_TIMEOUT
+};
+
+struct netchoice_data
+{
+    char entry[NETCHOICE_ENTRY_MAX];
+    int done;
+};
+
+/*
+ * Reply handler: the payload is the entry, trailing whitespace stripped
+ */
+static grub_err_t
+netchoice_recv (grub_net_udp_socket_t sock __attribute__ ((unused)),
+                struct grub_net_buff *nb,
+                void *data_)
+{
+    struct netchoice_data *data = data_;
+    grub_size_t len = nb->tail - nb->data;
+
+    if (!data->done && len > 0)
+    {
+        if (len >= NETCHOICE_ENTRY_MAX)
+            len = NETCHOICE_ENTRY_MAX - 1;
+        grub_memcpy (data->entry, nb->data, len);
+        while (len > 0 && grub_isspace (data->entry[len - 1]))
+            len--;
+        data->entry[len] = '\0';
+        data->done = (len > 0);
+        grub_dprintf ("netchoice", "Reply: `%s'\n", data->entry);
+    }
+
+    grub_netbuff_free (nb);
+    return GRUB_ERR_NONE;
+}
+
+static grub_err_t
+netchoice_send (grub_net_udp_socket_t sock, const char *msg)
+{
+    grub_size_t len = grub_strlen (msg);
+    grub_size_t headroom = GRUB_NET_OUR_MAX_IP_HEADER_SIZE
+                           + GRUB_NET_MAX_LINK_HEADER_SIZE
+                           + GRUB_NET_UDP_HEADER_SIZE;
+    struct grub_net_buff *nb;
+    grub_err_t err;
+
+    nb = grub_netbuff_alloc (headroom + len);
+    if (!nb)
+        return grub_errno;
+
+    err = grub_netbuff_reserve (nb, headroom);
+    if (!err)
+        err = grub_netbuff_put (nb, len);
+    if (!err)
+    {
+        grub_memcpy (nb->data, msg, len);
+        err = grub_net_send_udp_packet (sock, nb);
+    }
+
+    grub_netbuff_free (nb);
+    return err;
+}
+
+static grub_err_t
+grub_cmd_netchoice (grub_extcmd_context_t ctxt,
+                    int argc __attribute__ ((unused)),
+                    char **args __attribute__ ((unused)))
+{
+    struct grub_arg_list *state = ctxt->state;
+    struct netchoice_data data;
+    grub_net_network_level_address_t addr;
+    grub_net_udp_socket_t sock;
+    const char *server;
+    const char *id;
+    char *request;
+    grub_uint16_t port = NETCHOICE_PORT;
+    grub_uint64_t window = NETCHOICE_WINDOW_MS;
+    grub_uint64_t start;
+    grub_err_t err;
+
+    server = state[OPTION_SERVER].set ? state[OPTION_SERVER].arg
+                                      : grub_env_get ("netchoice_server");
+    if (!server || !*server)
+        return grub_error (GRUB_ERR_BAD_ARGUMENT,
+                           N_("no server given (--server or $netchoice_server)"));
+    if (state[OPTION_PORT].set)
+        port = grub_strtoul (state[OPTION_PORT].arg, 0, 0);
+    if (state[OPTION_TIMEOUT].set)
+        window = grub_strtoul (state[OPTION_TIMEOUT].arg, 0, 0);
+
+    err = grub_net_resolve_address (server, &addr);
+    if (err)
+        return err;
+
+    id = grub_env_get ("netchoice_id");
+    request = grub_xasprintf (NETCHOICE_REQUEST " %s", id ? id : "");
+    if (!request)
+        return grub_errno;
+
+    grub_memset (&data, 0, sizeof (data));
+    sock = grub_net_udp_open (addr, port, netchoice_recv, &data);
+    if (!sock)
+    {
+        grub_free (request);
+        return grub_errno;
+    }
+
+    grub_dprintf ("netchoice", "Asking %s:%d for %llu ms\n", server, port,
+                  (unsigned long long) window);
+
+    start = grub_get_time_ms ();
+    while (!data.done && grub_get_time_ms () - start < window)
+    {
+        /* Lost requests are retried on the next round */
+        if (netchoice_send (sock, request))
+            grub_errno = GRUB_ERR_NONE;
+
+        grub_net_poll_cards (NETCHOICE_RETRY_MS, &data.done);
+
+        /* Escape gives up early and leaves the menu as it is */
+        if (grub_getkey_noblock () == GRUB_TERM_ESC)
+            break;
+    }
+
+    grub_net_udp_close (sock);
+    grub_free (request);
+
+    if (!data.done)
+        return grub_error (GRUB_ERR_TIMEOUT, N_("no boot choice received"));
+
+    grub_printf ("netchoice: booting `%s'\n", data.entry);
+    grub_env_set ("default", data.entry);
+    grub_env_set ("timeout", "0");
+
+    return GRUB_ERR_NONE;
+}
+
+static grub_extcmd_t cmd;
+
+GRUB_MOD_INIT (net_choice)
+{
+    cmd = grub_register_extcmd ("netchoice", grub_cmd_netchoice, 0,
+                                N_("[--server ADDR] [--port PORT] [--timeout MS]"),
+                                N_("Ask a server on the network which entry to boot."),
+                                options);
+}
+
+GRUB_MOD_FINI (net_choice)
+{
+    grub_unregister_extcmd (cmd);
+}
@@ -9,6 +9,9 @@
  * 2. Properly initializes the USB device using HID protocol commands
  * 3. Parses standard 8-byte HID gamepad reports
  * 4. Registers as a terminal input device
+ * 5. Replays key macros bound to button chords (see "Input macros" below)
+ * 6. Times each attach step; `snes_status` reports it per slot
+ * 7. Learns the idle report before emitting keys (see "Idle calibration")
  *
  * HID Report Format (Generic SNES):
  *   Byte 0: X-axis (0x00=Left, 0x7F=Center, 0xFF=Right)
@@ -25,6 +28,8 @@
 #include <grub/usb.h>
 #include <grub/misc.h>
 #include <grub/time.h>
+#include <grub/env.h>
+#include <grub/command.h>
 
 GRUB_MOD_LICENSE ("GPLv3+");
 
@@ -54,11 +59,34 @@ GRUB_MOD_LICENSE ("GPLv3+");
 #define USB_REPORT_SIZE         8
 
 /*
- * D-pad axis processing
+ * D-pad axis processing (relative to the calibrated idle report)
  */
 #define AXIS_CENTER             0x7F
 #define AXIS_THRESHOLD          0x40
 
+/*
+ * Idle calibration
+ *
+ * 2.4 GHz receivers (8BitDo and friends) enumerate long before the pad has
+ * linked and send all-zero or all-0xFF reports meanwhile, which read as
+ * "left+up held" and produce bursts of phantom keys.  So no key is emitted
+ * until the idle report is known:
+ *
+ *  - all-0x00 / all-0xFF reports mean "no link" and restart calibration
+ *  - a report that stays unchanged for CALIB_STABLE_MS with both axes within
+ *    CALIB_AXIS_SLACK of center becomes the idle report
+ *  - if nothing at all arrives within CALIB_WINDOW_MS (pads that only report
+ *    on change), baseline_report is assumed
+ *
+ * Axes are then read relative to the learned center.  Button bits set in
+ * the idle report are ignored until a report shows them released: a button
+ * held (or mashed) while calibrating is a press, not part of the idle state,
+ * and must not stay masked for the rest of the session.
+ */
+#define CALIB_STABLE_MS         120
+#define CALIB_WINDOW_MS         500
+#define CALIB_AXIS_SLACK        0x20
+
 /*
  * SNES Button bit masks (in report byte 4)
  */
@@ -77,22 +105,41 @@ GRUB_MOD_LICENSE ("GPLv3+");
  */
 #define ACCEPT_ANY_HID  1
 
+/*
+ * Per-device attach quirks
+ *
+ * Some pads stall SET_PROTOCOL / SET_IDLE and every stalled request costs
+ * the host controller's full control-transfer timeout.  Known offenders get
+ * a flag here; any device can also be flagged from grubenv with
+ *   snes_quirks_VVVV_PPPP=noprotocol,noidle   (lowercase hex VID/PID)
+ */
+#define QUIRK_NO_SET_PROTOCOL   (1 << 0)
+#define QUIRK_NO_SET_IDLE       (1 << 1)
+
+/*
+ * Unknown devices: SET_PROTOCOL is only sent to boot-subclass interfaces
+ * (the HID spec does not define it elsewhere), and if a request fails or
+ * takes longer than this, the remaining optional requests are skipped.
+ */
+#define UNKNOWN_CTRL_BUDGET_MS  50
+
 struct snes_device_id {
     grub_uint16_t vid;
     grub_uint16_t pid;
     const char *name;
+    unsigned quirks;
 };
 
 static const struct snes_device_id known_devices[] = {
-    { 0x0810, 0xe501, "Generic SNES (0810:e501)" },
-    { 0x0079, 0x0011, "DragonRise (0079:0011)" },
-    { 0x0583, 0x2060, "iBuffalo SNES (0583:2060)" },
-    { 0x2dc8, 0x9018, "8BitDo SN30 (2dc8:9018)" },
-    { 0x12bd, 0xd015, "Generic 2-pack (12bd:d015)" },
-    { 0x1a34, 0x0802, "USB Gamepad (1a34:0802)" },
-    { 0x0810, 0x0001, "Generic Gamepad (0810:0001)" },
-    { 0x0079, 0x0006, "DragonRise (0079:0006)" },
-    { 0x0000, 0x0000, NULL }  /* End marker */
+    { 0x0810, 0xe501, "Generic SNES (0810:e501)", 0 },
+    { 0x0079, 0x0011, "DragonRise (0079:0011)", 0 },
+    { 0x0583, 0x2060, "iBuffalo SNES (0583:2060)", 0 },
+    { 0x2dc8, 0x9018, "8BitDo SN30 (2dc8:9018)", 0 },
+    { 0x12bd, 0xd015, "Generic 2-pack (12bd:d015)", 0 },
+    { 0x1a34, 0x0802, "USB Gamepad (1a34:0802)", 0 },
+    { 0x0810, 0x0001, "Generic Gamepad (0810:0001)", 0 },
+    { 0x0079, 0x0006, "DragonRise (0079:0006)", 0 },
+    { 0x0000, 0x0000, NULL, 0 }  /* End marker */
 };
 
 /*
@@ -111,21 +158,113 @@ static int key_y      = GRUB_TERM_ESC;          /* Escape - back */
 static int key_l      = GRUB_TERM_KEY_PPAGE;    /* Page up */
 static int key_r      = GRUB_TERM_KEY_NPAGE;    /* Page down */
 
+/*
+ * Input macros
+ *
+ * When a button is pressed, the set of buttons currently held is turned
+ * into a variable name, buttons in the order x a b y l r select start:
+ *
+ *   L + R + A      -> snes_macro_a_l_r
+ *   Select + Start -> snes_macro_select_start
+ *
+ * If that variable is set (grubenv via load_env, or a profile file pulled
+ * in with `source`), its value is replayed as keystrokes instead of the
+ * normal button mapping.  Plain characters are typed as-is; {name} tokens
+ * give special keys: {up} {down} {left} {right} {home} {end} {pgup} {pgdn}
+ * {del} {bs} {tab} {enter} {esc} {f10} {lbrace} {rbrace} {ctrl-X} {wait}.
+ *
+ * Keys are emitted one every snes_macro_delay ms (default 25) so the entry
+ * editor keeps up; {wait} pauses MACRO_WAIT_MS.  Example (rescue boot of
+ * the first entry, linux line is the 4th line of the entry):
+ *
+ *   snes_macro_a_l_r=e{down}{down}{down}{end} systemd.unit=rescue.target{f10}
+ */
+#define MACRO_CAPACITY          256
+#define MACRO_DEFAULT_DELAY_MS  25
+#define MACRO_WAIT_MS           250
+#define MACRO_KEY_WAIT          (-1)
+#define MACRO_VAR_PREFIX        "snes_macro"
+
+static const struct
+{
+    grub_uint8_t mask;
+    const char *name;
+} macro_buttons[] = {
+    { BTN_X, "x" }, { BTN_A, "a" }, { BTN_B, "b" }, { BTN_Y, "y" },
+    { BTN_L, "l" }, { BTN_R, "r" }, { BTN_SELECT, "select" }, { BTN_START, "start" },
+};
+
+static const struct
+{
+    const char *name;
+    int key;
+} macro_tokens[] = {
+    { "up",     GRUB_TERM_KEY_UP },
+    { "down",   GRUB_TERM_KEY_DOWN },
+    { "left",   GRUB_TERM_KEY_LEFT },
+    { "right",  GRUB_TERM_KEY_RIGHT },
+    { "home",   GRUB_TERM_KEY_HOME },
+    { "end",    GRUB_TERM_KEY_END },
+    { "pgup",   GRUB_TERM_KEY_PPAGE },
+    { "pgdn",   GRUB_TERM_KEY_NPAGE },
+    { "del",    GRUB_TERM_KEY_DC },
+    { "bs",     GRUB_TERM_BACKSPACE },
+    { "tab",    GRUB_TERM_TAB },
+    { "enter",  '\r' },
+    { "esc",    GRUB_TERM_ESC },
+    { "f10",    GRUB_TERM_KEY_F10 },
+    { "lbrace", '{' },
+    { "rbrace", '}' },
+    { "wait",   MACRO_KEY_WAIT },
+};
+
+/*
+ * Attach step durations in ms, ATTACH_SKIPPED if the step was not run
+ */
+#define ATTACH_SKIPPED  (-1)
+
+struct snes_attach_timing
+{
+    int config_ms;
+    int protocol_ms;
+    int idle_ms;
+    int total_ms;
+    grub_usb_err_t config_err;
+    grub_usb_err_t protocol_err;
+    grub_usb_err_t idle_err;
+};
+
 /*
  * Per-device state structure
  */
 struct grub_usb_snes_data
 {
     grub_usb_device_t usbdev;
+    const char *name;
+    unsigned quirks;
+    struct snes_attach_timing timing;
     int configno;
     int interfno;
     struct grub_usb_desc_endp *endp;
     grub_usb_transfer_t transfer;
     grub_uint8_t report[USB_REPORT_SIZE];
     grub_uint8_t prev_report[USB_REPORT_SIZE];
+    grub_uint8_t idle_report[USB_REPORT_SIZE];
+    int calibrated;
+    int link_up;
+    int have_report;
+    grub_uint64_t attach_ms;
+    grub_uint64_t stable_since_ms;
     int key_queue[KEY_QUEUE_CAPACITY];
     int key_queue_begin;
     int key_queue_size;
+    int macro[MACRO_CAPACITY];
+    int macro_len;
+    int macro_pos;
+    grub_uint32_t macro_delay_ms;
+    grub_uint64_t macro_next_ms;
+    grub_uint8_t macro_held;
+    int macro_fired;
 };
 
 /*
@@ -178,18 +317,333 @@ key_queue_pop (struct grub_usb_snes_data *data)
 /*
  * Check if this is a known SNES controller
  */
-static const char *
-get_device_name (grub_uint16_t vid, grub_uint16_t pid)
+static const struct snes_device_id *
+get_known_device (grub_uint16_t vid, grub_uint16_t pid)
 {
     int i;
     for (i = 0; known_devices[i].name != NULL; i++)
     {
         if (known_devices[i].vid == vid && known_devices[i].pid == pid)
-            return known_devices[i].name;
+            return &known_devices[i];
     }
     return NULL;
 }
 
+/*
+ * Quirk flags from grubenv (snes_quirks_VVVV_PPPP=noprotocol,noidle)
+ */
+static unsigned
+get_env_quirks (grub_uint16_t vid, grub_uint16_t pid)
+{
+    char name[sizeof ("snes_quirks_vvvv_pppp")];
+    const char *val;
+    unsigned quirks = 0;
+
+    grub_snprintf (name, sizeof (name), "snes_quirks_%04x_%04x", vid, pid);
+    val = grub_env_get (name);
+    if (!val)
+        return 0;
+
+    if (grub_strstr (val, "noprotocol"))
+        quirks |= QUIRK_NO_SET_PROTOCOL;
+    if (grub_strstr (val, "noidle"))
+        quirks |= QUIRK_NO_SET_IDLE;
+    return quirks;
+}
+
+/*
+ * HID class request to the interface, timed
+ */
+static grub_usb_err_t
+timed_hid_request (grub_usb_device_t usbdev, grub_uint8_t request,
+                   grub_uint16_t value, int interfno, int *ms)
+{
+    grub_uint64_t start = grub_get_time_ms ();
+    grub_usb_err_t err;
+
+    err = grub_usb_control_msg (usbdev,
+                                GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT,
+                                request,
+                                value,
+                                interfno,
+                                0,
+                                NULL);
+    *ms = grub_get_time_ms () - start;
+    return err;
+}
+
+/*
+ * Macro handling
+ */
+static int
+macro_token_key (const char *tok, grub_size_t len)
+{
+    char name[16];
+    unsigned i;
+
+    if (len == 6 && grub_strncmp (tok, "ctrl-", 5) == 0)
+        return GRUB_TERM_CTRL | grub_tolower (tok[5]);
+
+    for (i = 0; i < ARRAY_SIZE (macro_tokens); i++)
+    {
+        if (grub_strlen (macro_tokens[i].name) == len &&
+            grub_strncmp (macro_tokens[i].name, tok, len) == 0)
+            return macro_tokens[i].key;
+    }
+
+    /* GRUB's printf has no %.*s: print a bounded, terminated copy */
+    if (len >= sizeof (name))
+        len = sizeof (name) - 1;
+    grub_memcpy (name, tok, len);
+    name[len] = '\0';
+    grub_dprintf ("usb_snes", "Unknown macro token {%s}\n", name);
+    return GRUB_TERM_NO_KEY;
+}
+
+static void
+macro_load (struct grub_usb_snes_data *data, const char *seq)
+{
+    const char *p = seq;
+    const char *delay;
+    const char *end;
+
+    data->macro_len = 0;
+    data->macro_pos = 0;
+
+    while (*p && data->macro_len < MACRO_CAPACITY)
+    {
+        int key = (unsigned char) *p++;
+
+        if (key == '{')
+        {
+            const char *end = grub_strchr (p, '}');
+            if (end)
+            {
+                key = macro_token_key (p, end - p);
+                p = end + 1;
+            }
+        }
+
+        if (key != GRUB_TERM_NO_KEY)
+            data->macro[data->macro_len++] = key;
+    }
+
+    data->macro_delay_ms = MACRO_DEFAULT_DELAY_MS;
+    delay = grub_env_get (MACRO_VAR_PREFIX "_delay");
+    if (delay)
+    {
+        unsigned long ms = grub_strtoul (delay, &end, 10);
+
+        if (grub_errno != GRUB_ERR_NONE || end == delay || *end != '\0')
+        {
+            /* Bad value: keep the default, don't leak the error */
+            grub_dprintf ("usb_snes", "Bad " MACRO_VAR_PREFIX "_delay '%s'\n", delay);
+            grub_errno = GRUB_ERR_NONE;
+        }
+        else
+            data->macro_delay_ms = ms;
+    }
+    data->macro_next_ms = grub_get_time_ms ();
+}
+
+#define MACRO_NAME_SIZE (sizeof (MACRO_VAR_PREFIX) + sizeof ("_x_a_b_y_l_r_select_start"))
+
+static const char *
+macro_lookup (grub_uint8_t buttons)
+{
+    char name[MACRO_NAME_SIZE];
+    grub_size_t len = sizeof (MACRO_VAR_PREFIX) - 1;
+    const char *seq;
+    unsigned i;
+
+    grub_memcpy (name, MACRO_VAR_PREFIX, len);
+    for (i = 0; i < ARRAY_SIZE (macro_buttons); i++)
+    {
+        grub_size_t n;
+
+        if (!(buttons & macro_buttons[i].mask))
+            continue;
+        n = grub_strlen (macro_buttons[i].name);
+        name[len++] = '_';
+        grub_memcpy (name + len, macro_buttons[i].name, n);
+        len += n;
+    }
+    name[len] = '\0';
+
+    seq = grub_env_get (name);
+    return (seq && *seq) ? seq : NULL;
+}
+
+/*
+ * Look up a macro for the buttons currently held.
+ * Returns 1 if one was started.
+ */
+static int
+macro_try_start (struct grub_usb_snes_data *data, grub_uint8_t buttons)
+{
+    const char *seq = macro_lookup (buttons);
+
+    if (!seq)
+        return 0;
+
+    grub_dprintf ("usb_snes", "Macro for buttons 0x%02x: %s\n", buttons, seq);
+    macro_load (data, seq);
+    return data->macro_len > 0;
+}
+
+/*
+ * Could one or two more buttons complete a bound chord?  Presses that
+ * may start a chord are held back until it completes or they are released.
+ */
+static int
+macro_chord_possible (grub_uint8_t buttons)
+{
+    unsigned i, j;
+
+    for (i = 0; i < 8; i++)
+    {
+        grub_uint8_t one = buttons | (1 << i);
+
+        if (one == buttons)
+            continue;
+        if (macro_lookup (one))
+            return 1;
+        for (j = i + 1; j < 8; j++)
+        {
+            grub_uint8_t two = one | (1 << j);
+            if (two != one && macro_lookup (two))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Next paced macro key, or GRUB_TERM_NO_KEY if it is not time yet
+ */
+static int
+macro_next_key (struct grub_usb_snes_data *data)
+{
+    grub_uint64_t now = grub_get_time_ms ();
+    int key;
+
+    if (now < data->macro_next_ms)
+        return GRUB_TERM_NO_KEY;
+
+    key = data->macro[data->macro_pos++];
+    if (key == MACRO_KEY_WAIT)
+    {
+        data->macro_next_ms = now + MACRO_WAIT_MS;
+        return GRUB_TERM_NO_KEY;
+    }
+
+    data->macro_next_ms = now + data->macro_delay_ms;
+    return key;
+}
+
+/*
+ * Idle calibration (see "Idle calibration" above)
+ */
+static int
+report_link_down (struct grub_usb_snes_data *data, const grub_uint8_t *r)
+{
+    int i;
+
+    for (i = 1; i < USB_REPORT_SIZE; i++)
+        if (r[i] != r[0])
+            return 0;
+    if (r[0] != 0x00 && r[0] != 0xFF)
+        return 0;
+
+    /*
+     * Once calibrated, a real up-left press can be all-zero on pads whose
+     * unused bytes are zero; only trust it if those bytes changed too.
+     */
+    if (data->calibrated && r[2] == data->idle_report[2] && r[3] == data->idle_report[3])
+        return 0;
+    return 1;
+}
+
+static int
+axis_centered (grub_uint8_t v)
+{
+    return v >= AXIS_CENTER - CALIB_AXIS_SLACK && v <= AXIS_CENTER + CALIB_AXIS_SLACK;
+}
+
+/* LATEST is the most recent report, or prev_report when polling */
+static void
+calibrate_check (struct grub_usb_snes_data *data, const grub_uint8_t *latest,
+                 grub_uint64_t now)
+{
+    if (!data->have_report)
+    {
+        if (now - data->attach_ms >= CALIB_WINDOW_MS)
+        {
+            grub_memcpy (data->idle_report, baseline_report, USB_REPORT_SIZE);
+            data->calibrated = 1;
+            grub_dprintf ("usb_snes", "No report in %d ms, assuming default idle\n",
+                          CALIB_WINDOW_MS);
+        }
+        return;
+    }
+
+    if (!data->link_up || now - data->stable_since_ms < CALIB_STABLE_MS)
+        return;
+    if (!axis_centered (latest[0]) || !axis_centered (latest[1]))
+        return;
+
+    grub_memcpy (data->idle_report, latest, USB_REPORT_SIZE);
+    data->calibrated = 1;
+    grub_dprintf ("usb_snes", "Idle report %02x %02x %02x %02x %02x %02x %02x %02x\n",
+                  latest[0], latest[1], latest[2], latest[3],
+                  latest[4], latest[5], latest[6], latest[7]);
+}
+
+/*
+ * Returns 1 if the new report should be decoded into keys
+ */
+static int
+calibrate_report (struct grub_usb_snes_data *data)
+{
+    const grub_uint8_t *r = data->report;
+    grub_uint64_t now = grub_get_time_ms ();
+
+    if (report_link_down (data, r))
+    {
+        if (data->link_up)
+            grub_dprintf ("usb_snes", "Link down, recalibrating\n");
+        data->link_up = 0;
+        data->calibrated = 0;
+        data->have_report = 1;
+        data->macro_held = 0;
+        return 0;
+    }
+
+    if (!data->link_up)
+    {
+        grub_dprintf ("usb_snes", "Link up\n");
+        data->link_up = 1;
+        data->stable_since_ms = now;
+    }
+
+    if (data->calibrated)
+    {
+        if (data->idle_report[4] & ~r[4])
+        {
+            grub_dprintf ("usb_snes", "Idle buttons 0x%02x released, unmasking\n",
+                          data->idle_report[4] & ~r[4]);
+            data->idle_report[4] &= r[4];
+        }
+        return 1;
+    }
+
+    if (!data->have_report || grub_memcmp (r, data->prev_report, USB_REPORT_SIZE) != 0)
+        data->stable_since_ms = now;
+    data->have_report = 1;
+    calibrate_check (data, r, now);
+    return 0;
+}
+
 /*
  * Process HID report and generate key events
  */
@@ -198,18 +652,19 @@ process_report (struct grub_usb_snes_data *data)
 {
     grub_uint8_t *prev = data->prev_report;
     grub_uint8_t *curr = data->report;
+    const grub_uint8_t *idle = data->idle_report;
 
     /* D-pad from X-axis (byte 0) */
-    int prev_left  = (prev[0] < AXIS_CENTER - AXIS_THRESHOLD);
-    int prev_right = (prev[0] > AXIS_CENTER + AXIS_THRESHOLD);
-    int curr_left  = (curr[0] < AXIS_CENTER - AXIS_THRESHOLD);
-    int curr_right = (curr[0] > AXIS_CENTER + AXIS_THRESHOLD);
+    int prev_left  = (prev[0] < idle[0] - AXIS_THRESHOLD);
+    int prev_right = (prev[0] > idle[0] + AXIS_THRESHOLD);
+    int curr_left  = (curr[0] < idle[0] - AXIS_THRESHOLD);
+    int curr_right = (curr[0] > idle[0] + AXIS_THRESHOLD);
 
     /* D-pad from Y-axis (byte 1) */
-    int prev_up   = (prev[1] < AXIS_CENTER - AXIS_THRESHOLD);
-    int prev_down = (prev[1] > AXIS_CENTER + AXIS_THRESHOLD);
-    int curr_up   = (curr[1] < AXIS_CENTER - AXIS_THRESHOLD);
-    int curr_down = (curr[1] > AXIS_CENTER + AXIS_THRESHOLD);
+    int prev_up   = (prev[1] < idle[1] - AXIS_THRESHOLD);
+    int prev_down = (prev[1] > idle[1] + AXIS_THRESHOLD);
+    int curr_up   = (curr[1] < idle[1] - AXIS_THRESHOLD);
+    int curr_down = (curr[1] > idle[1] + AXIS_THRESHOLD);
 
     /* Generate key events on press (not release) */
     if (!prev_up && curr_up)
@@ -221,27 +676,56 @@ process_report (struct grub_usb_snes_data *data)
     if (!prev_right && curr_right)
         key_queue_push (data, key_right);
 
-    /* Buttons from byte 4 */
-    grub_uint8_t prev_btns = prev[4];
-    grub_uint8_t curr_btns = curr[4];
+    /* Buttons from byte 4, bits set at idle are not buttons */
+    grub_uint8_t prev_btns = prev[4] & ~idle[4];
+    grub_uint8_t curr_btns = curr[4] & ~idle[4];
 
-#define BTN_PRESSED(p, c, m) (!(p & m) && (c & m))
+    grub_uint8_t pressed = curr_btns & ~prev_btns;
+    grub_uint8_t emit = pressed;
 
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_A))
+    if (pressed)
+    {
+        /* A press completing a bound chord replaces the normal mapping */
+        if (macro_try_start (data, curr_btns))
+        {
+            data->macro_held = 0;
+            data->macro_fired = 1;
+            return;
+        }
+        if (macro_chord_possible (curr_btns))
+        {
+            data->macro_held |= pressed;
+            emit = 0;
+        }
+    }
+
+    /* Released before a chord completed: deliver the held presses now */
+    if (data->macro_held & ~curr_btns)
+    {
+        if (!data->macro_fired)
+            emit |= data->macro_held;
+        data->macro_held = 0;
+    }
+    if (!curr_btns)
+        data->macro_fired = 0;
+
+#define BTN_PRESSED(m) (emit & (m))
+
+    if (BTN_PRESSED (BTN_A))
         key_queue_push (data, key_a);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_B))
+    if (BTN_PRESSED (BTN_B))
         key_queue_push (data, key_b);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_X))
+    if (BTN_PRESSED (BTN_X))
         key_queue_push (data, key_x);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_Y))
+    if (BTN_PRESSED (BTN_Y))
         key_queue_push (data, key_y);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_START))
+    if (BTN_PRESSED (BTN_START))
         key_queue_push (data, key_start);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_SELECT))
+    if (BTN_PRESSED (BTN_SELECT))
         key_queue_push (data, key_select);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_L))
+    if (BTN_PRESSED (BTN_L))
         key_queue_push (data, key_l);
-    if (BTN_PRESSED (prev_btns, curr_btns, BTN_R))
+    if (BTN_PRESSED (BTN_R))
         key_queue_push (data, key_r);
 
 #undef BTN_PRESSED
@@ -266,8 +750,9 @@ grub_usb_snes_getkey (struct grub_term_input *term)
         /* Transfer completed (success or error) */
         if (err == GRUB_USB_ERR_NONE && actual == USB_REPORT_SIZE)
         {
-            /* Valid report received - process it */
-            process_report (data);
+            /* Valid report received - process it once calibrated */
+            if (calibrate_report (data))
+                process_report (data);
         }
 
         /* Save current report as previous */
@@ -286,6 +771,15 @@ grub_usb_snes_getkey (struct grub_term_input *term)
             grub_print_error ();
         }
     }
+    else if (!data->calibrated)
+    {
+        /* Pads that report only on change: the idle report stays stable */
+        calibrate_check (data, data->prev_report, grub_get_time_ms ());
+    }
+
+    /* Macro keys go first; regular keys wait until it has finished */
+    if (data->macro_pos < data->macro_len)
+        return macro_next_key (data);
 
     return key_queue_pop (data);
 }
@@ -349,7 +843,12 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
     unsigned curnum;
     struct grub_usb_snes_data *data;
     struct grub_usb_desc_endp *endp = NULL;
+    const struct snes_device_id *known;
     const char *device_name;
+    struct snes_attach_timing *timing;
+    grub_uint64_t attach_start = grub_get_time_ms ();
+    grub_uint64_t step_start;
+    int budget_exceeded = 0;
     int j;
 
     grub_dprintf ("usb_snes", "Attach: VID=%04x PID=%04x config=%d interf=%d\n",
@@ -359,7 +858,8 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
     /*
      * Check if this is a device we want to handle
      */
-    device_name = get_device_name (usbdev->descdev.vendorid, usbdev->descdev.prodid);
+    known = get_known_device (usbdev->descdev.vendorid, usbdev->descdev.prodid);
+    device_name = known ? known->name : NULL;
 
 #if ACCEPT_ANY_HID
     /*
@@ -424,22 +924,43 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
 
     /* Initialize data structure */
     data->usbdev = usbdev;
+    data->name = device_name;
+    data->quirks = (known ? known->quirks : 0)
+                   | get_env_quirks (usbdev->descdev.vendorid, usbdev->descdev.prodid);
     data->configno = configno;
     data->interfno = interfno;
     data->endp = endp;
     data->key_queue_begin = 0;
     data->key_queue_size = 0;
+    data->macro_len = 0;
+    data->macro_pos = 0;
+    data->macro_held = 0;
+    data->macro_fired = 0;
     grub_memcpy (data->prev_report, baseline_report, USB_REPORT_SIZE);
+    grub_memcpy (data->idle_report, baseline_report, USB_REPORT_SIZE);
     grub_memset (data->report, 0, USB_REPORT_SIZE);
+    data->calibrated = 0;
+    data->link_up = 0;
+    data->have_report = 0;
+    data->attach_ms = attach_start;
+    data->stable_since_ms = attach_start;
 
     /*
      * USB Device Initialization Sequence
      * Following the pattern from usb_keyboard.c
      */
 
+    timing = &data->timing;
+    timing->protocol_ms = ATTACH_SKIPPED;
+    timing->idle_ms = ATTACH_SKIPPED;
+    timing->protocol_err = GRUB_USB_ERR_NONE;
+    timing->idle_err = GRUB_USB_ERR_NONE;
+
     /* Step 1: Set USB configuration */
     grub_dprintf ("usb_snes", "Setting configuration %d\n", configno + 1);
-    grub_usb_set_configuration (usbdev, configno + 1);
+    step_start = grub_get_time_ms ();
+    timing->config_err = grub_usb_set_configuration (usbdev, configno + 1);
+    timing->config_ms = grub_get_time_ms () - step_start;
 
     /*
      * Step 2: Set HID protocol to Boot Protocol (0)
@@ -447,16 +968,21 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
      * Request: USB_HID_SET_PROTOCOL (0x0B)
      * Value: 0 = Boot Protocol, 1 = Report Protocol
      * Index: Interface number
-     * Some devices may not support this, but it shouldn't hurt to try
+     * Skipped for flagged devices, and for unknown devices whose interface
+     * is not boot subclass (the request is undefined there and some stall)
      */
-    grub_dprintf ("usb_snes", "Setting boot protocol on interface %d\n", interfno);
-    grub_usb_control_msg (usbdev,
-                          GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT,
-                          USB_HID_SET_PROTOCOL,
-                          0,        /* Boot protocol */
-                          interfno,
-                          0,
-                          NULL);
+    if (!(data->quirks & QUIRK_NO_SET_PROTOCOL) &&
+        (known || usbdev->config[configno].interf[interfno].descif->subclass
+                  == USB_HID_BOOT_SUBCLASS))
+    {
+        grub_dprintf ("usb_snes", "Setting boot protocol on interface %d\n", interfno);
+        timing->protocol_err = timed_hid_request (usbdev, USB_HID_SET_PROTOCOL,
+                                                  0,        /* Boot protocol */
+                                                  interfno, &timing->protocol_ms);
+        if (!known && (timing->protocol_err != GRUB_USB_ERR_NONE ||
+                       timing->protocol_ms > UNKNOWN_CTRL_BUDGET_MS))
+            budget_exceeded = 1;
+    }
 
     /*
      * Step 3: Set idle rate to 0 (report only on changes)
@@ -465,14 +991,18 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
      * Value: Duration (0 = indefinite) | Report ID (0)
      * Index: Interface number
      */
-    grub_dprintf ("usb_snes", "Setting idle rate\n");
-    grub_usb_control_msg (usbdev,
-                          GRUB_USB_REQTYPE_CLASS_INTERFACE_OUT,
-                          USB_HID_SET_IDLE,
-                          0 << 8,   /* Duration 0 = report on event only */
-                          interfno,
-                          0,
-                          NULL);
+    if (!(data->quirks & QUIRK_NO_SET_IDLE) && !budget_exceeded)
+    {
+        grub_dprintf ("usb_snes", "Setting idle rate\n");
+        timing->idle_err = timed_hid_request (usbdev, USB_HID_SET_IDLE,
+                                              0 << 8,   /* Duration 0 = report on event only */
+                                              interfno, &timing->idle_ms);
+    }
+
+    timing->total_ms = grub_get_time_ms () - attach_start;
+    grub_dprintf ("usb_snes", "Attach took %d ms (config %d, protocol %d, idle %d)\n",
+                  timing->total_ms, timing->config_ms,
+                  timing->protocol_ms, timing->idle_ms);
 
     /* Clear any USB errors from optional commands */
     grub_errno = GRUB_ERR_NONE;
@@ -514,11 +1044,61 @@ grub_usb_snes_attach (grub_usb_device_t usbdev, int configno, int interfno)
     /* Register as active terminal input */
     grub_term_register_input_active ("snes_gamepad", &gamepads[curnum]);
 
-    grub_printf ("SNES Gamepad connected: %s (slot %d)\n", device_name, curnum);
+    grub_printf ("SNES Gamepad connected: %s (slot %d, %d ms)\n",
+                 device_name, curnum, timing->total_ms);
 
     return 1;
 }
 
+/*
+ * snes_status: attached pads and where their attach time went
+ */
+static void
+print_step (const char *label, int ms, grub_usb_err_t err)
+{
+    if (ms == ATTACH_SKIPPED)
+        grub_printf ("    %-14s skipped\n", label);
+    else if (err != GRUB_USB_ERR_NONE)
+        grub_printf ("    %-14s %5d ms  (usb error %d)\n", label, ms, err);
+    else
+        grub_printf ("    %-14s %5d ms\n", label, ms);
+}
+
+static grub_err_t
+grub_cmd_snes_status (grub_command_t cmd __attribute__ ((unused)),
+                      int argc __attribute__ ((unused)),
+                      char **args __attribute__ ((unused)))
+{
+    unsigned i;
+    int found = 0;
+
+    for (i = 0; i < ARRAY_SIZE (gamepads); i++)
+    {
+        struct grub_usb_snes_data *data = gamepads[i].data;
+
+        if (!data)
+            continue;
+        found = 1;
+
+        grub_printf ("%s: %s [%04x:%04x] quirks=0x%x\n", gamepads[i].name, data->name,
+                     data->usbdev->descdev.vendorid, data->usbdev->descdev.prodid,
+                     data->quirks);
+        grub_printf ("  link %s, %s\n", data->link_up ? "up" : "down",
+                     data->calibrated ? "calibrated" : "calibrating");
+        grub_printf ("  attach %d ms\n", data->timing.total_ms);
+        print_step ("set_config", data->timing.config_ms, data->timing.config_err);
+        print_step ("SET_PROTOCOL", data->timing.protocol_ms, data->timing.protocol_err);
+        print_step ("SET_IDLE", data->timing.idle_ms, data->timing.idle_err);
+    }
+
+    if (!found)
+        grub_printf ("No SNES gamepad attached\n");
+
+    return GRUB_ERR_NONE;
+}
+
+static grub_command_t cmd_status;
+
 /*
  * USB attach hook registration
  */
@@ -533,6 +1113,8 @@ static struct grub_usb_attach_desc attach_hook = {
 GRUB_MOD_INIT (usb_snes_gamepad)
 {
     grub_dprintf ("usb_snes", "SNES Gamepad module loading...\n");
+    cmd_status = grub_register_command ("snes_status", grub_cmd_snes_status, 0,
+                                        "Show attached SNES gamepads and attach timing.");
     grub_usb_register_attach_hook_class (&attach_hook);
     grub_dprintf ("usb_snes", "SNES Gamepad module loaded\n");
 }
@@ -565,5 +1147,6 @@ GRUB_MOD_FINI (usb_snes_gamepad)
     }
 
     grub_usb_unregister_attach_hook_class (&attach_hook);
+    grub_unregister_command (cmd_status);
     grub_dprintf ("usb_snes", "SNES Gamepad module unloaded\n");
 }
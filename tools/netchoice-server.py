@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+Boot-choice server for the GRUB `netchoice` command (src/net_choice.c).
+
+GRUB sends "BOOTSEL? <netchoice_id>" datagrams while its listen window is
+open; this replies with the menu entry to boot.
+
+    ./tools/netchoice-server.py Windows                 # answer everyone
+    ./tools/netchoice-server.py --id rig3 2             # only netchoice_id=rig3
+    ./tools/netchoice-server.py --forever "Ubuntu"      # keep answering
+
+With QEMU user networking the guest reaches the host as 10.0.2.2, so run
+this on the host and use `netchoice --server 10.0.2.2` in the guest.
+"""
+
+import sys
+import time
+import socket
+import argparse
+
+REQUEST = b"BOOTSEL?"
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Reply to GRUB netchoice requests')
+    parser.add_argument('entry', help='Menu entry to boot (title, id or index)')
+    parser.add_argument('--port', type=int, default=7373, help='UDP port (default: 7373)')
+    parser.add_argument('--bind', default='0.0.0.0', help='Address to listen on')
+    parser.add_argument('--id', help='Only answer this netchoice_id')
+    parser.add_argument('--forever', action='store_true', help='Keep answering after the first reply')
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind((args.bind, args.port))
+    print(f"Listening on {args.bind}:{args.port}, answering '{args.entry}'")
+
+    while True:
+        data, peer = sock.recvfrom(512)
+        if not data.startswith(REQUEST):
+            continue
+        ident = data[len(REQUEST):].strip().decode(errors='replace')
+        if args.id is not None and ident != args.id:
+            print(f"{time.strftime('%H:%M:%S')} {peer[0]}:{peer[1]} id='{ident}' ignored")
+            continue
+        sock.sendto(args.entry.encode(), peer)
+        print(f"{time.strftime('%H:%M:%S')} {peer[0]}:{peer[1]} id='{ident}' -> '{args.entry}'")
+        if not args.forever:
+            return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)